@@ -0,0 +1,54 @@
+project "Benchmarks"
+   kind "ConsoleApp"
+   language "C++"
+   cppdialect "C++20"
+   targetdir "Binaries/%{cfg.buildcfg}"
+   staticruntime "off"
+
+   files { "Source/**.h", "Source/**.cpp" }
+
+   includedirs
+   {
+      "Source",
+	  -- Include Core
+	  "../Engine/Source",
+	  "../Engine/Vendor/glfw/include"
+   }
+
+   local vulkanSDKPath = os.getenv("VULKAN_SDK")
+   if vulkanSDKPath then
+      includedirs { vulkanSDKPath .. "/Include" }
+   end
+
+   links
+   {
+      "Engine"
+   }
+
+   targetdir ("../Binaries/" .. outputdir .. "/%{prj.name}")
+   objdir ("../Binaries/Intermediates/" .. outputdir .. "/%{prj.name}")
+
+   filter "system:windows"
+       systemversion "latest"
+       defines { "WINDOWS" }
+
+   -- Static libraries don't carry their system links on Linux
+   filter "system:linux"
+       links { "vulkan", "glfw", "pthread", "dl" }
+
+   filter "configurations:Debug"
+       defines { "DEBUG" }
+       runtime "Debug"
+       symbols "On"
+
+   filter "configurations:Release"
+       defines { "RELEASE" }
+       runtime "Release"
+       optimize "On"
+       symbols "On"
+
+   filter "configurations:Dist"
+       defines { "DIST" }
+       runtime "Release"
+       optimize "On"
+       symbols "Off"
\ No newline at end of file
@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+// The engine parses OBJs itself now, tinyobjloader is only kept as the baseline
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../Vendor/tiny_obj_loader/tiny_obj_loader.h"
+
+#include "Benchmark.h"
+#include "Containers/DynArray.h"
+#include "Engine/Assets/AssetLoader.h"
+#include "Engine/Assets/CookedMesh.h"
+#include "Engine/Assets/MappedFile.h"
+#include "Engine/Assets/MeshOptimizer.h"
+#include "Engine/Assets/Meshlets.h"
+#include "Engine/Assets/ObjParser.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Engine/Tasks/TaskExecutor.h"
+#include "Engine/Vulkan/VulkanModel.h"
+#include "Memory/Arena.h"
+#include "Memory/STLArenaAllocator.h"
+
+namespace benchmarks {
+
+namespace {
+
+using VulkanModel = engine::vulkan::VulkanModel;
+using Vertex = engine::vulkan::VulkanModel::Vertex;
+using VertexIndexInfo = engine::vulkan::VulkanModel::VertexIndexInfo;
+
+constexpr size_t asset_arena_size = 1 << 27;
+constexpr size_t job_arena_size = 1 << 22;
+// Big enough that parse_obj_parallel splits it, roughly 30MB of text
+constexpr int grid_size = 512;
+constexpr const char* model_names[] = {"cube.obj", "colored_cube.obj", "flat_vase.obj", "smooth_vase.obj", "AK-47.obj"};
+constexpr const char* benchmark_names[] = {"obj_parse", "obj_import", "vertex_weld", "mesh_optimize", "mesh_simplify", "meshlet_build", "vertex_encode", "cooked_load", "model_stream"};
+
+template <typename T>
+void hash_combine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// The per float hash load_model welded with before the flat table
+struct VertexHash {
+    size_t operator()(const Vertex& vertex) const noexcept {
+        size_t seed = 0;
+        const float* values = &vertex.position.x;
+        for (size_t i = 0; i < sizeof(Vertex) / sizeof(float); i++) {
+            hash_combine(seed, values[i]);
+        }
+        return seed;
+    }
+};
+
+void weld_with_unordered_map(Arena& temp_arena, VertexIndexInfo& info, const Vertex* unindexed_vertices, size_t vertex_count) {
+    using ArenaAllocator = STLArenaAllocator<std::pair<const Vertex, uint32_t>>;
+    std::unordered_map<Vertex, uint32_t, VertexHash, std::equal_to<>, ArenaAllocator> index_map{ArenaAllocator{&temp_arena}};
+    for (size_t i = 0; i < vertex_count; i++) {
+        const Vertex& vertex = unindexed_vertices[i];
+        if (index_map.count(vertex) == 0) {
+            index_map[vertex] = static_cast<uint32_t>(info.vertices.size());
+            info.vertices.push_back(vertex);
+        }
+        info.indices.push_back(index_map[vertex]);
+    }
+}
+
+// A grid of quads with uvs and normals, with every face index written out
+std::string make_grid_obj(int size) {
+    std::string text;
+    char line[128];
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            const float u = static_cast<float>(x) / static_cast<float>(size);
+            const float v = static_cast<float>(y) / static_cast<float>(size);
+            text.append(line, snprintf(line, sizeof(line), "v %f %f %f\nvt %f %f\nvn 0 1 0\n", u, 0.f, v, u, v));
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            const int a = y * (size + 1) + x + 1;
+            const int b = a + 1;
+            const int c = a + size + 2;
+            const int d = a + size + 1;
+            text.append(line, snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c, d, d, d));
+        }
+    }
+    return text;
+}
+
+}
+
+void run_asset_benchmarks(const BenchmarkRunner& runner, const char* models_directory) {
+    if (std::none_of(std::begin(benchmark_names), std::end(benchmark_names), [&](const char* name) { return runner.should_run(name); })) {
+        return;
+    }
+    Arena temp_arena{asset_arena_size};
+    Arena model_arena{asset_arena_size};
+    Arena stream_arena{asset_arena_size};
+    Arena job_arena{job_arena_size};
+    engine::jobs::JobSystem job_system{job_arena};
+    for (const char* model_name : model_names) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", models_directory, model_name);
+        if (FILE* file = fopen(path, "rb")) {
+            fclose(file);
+        } else {
+            fprintf(stderr, "Skipping %s, file not found\n", path);
+            continue;
+        }
+
+        // Text to attribute streams only, no expansion or welding
+        char variant[128];
+        snprintf(variant, sizeof(variant), "%s tinyobj", model_name);
+        runner.run("obj_parse", variant, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                std::vector<tinyobj::material_t> materials;
+                std::string warn;
+                std::string err;
+                tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path);
+                do_not_optimize(attrib.vertices.data());
+            }
+        });
+        snprintf(variant, sizeof(variant), "%s streaming", model_name);
+        runner.run("obj_parse", variant, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                engine::assets::MappedFile file;
+                file.open(path);
+                engine::assets::ObjStreams streams{temp_arena};
+                engine::assets::parse_obj(reinterpret_cast<const char*>(file.data()), file.size(), streams);
+                do_not_optimize(streams.corners.data());
+                temp_arena.clear();
+            }
+        });
+
+        runner.run("obj_import", model_name, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                VertexIndexInfo info{model_arena};
+                info.load_model(temp_arena, path);
+                do_not_optimize(info.indices.size());
+                model_arena.clear();
+            }
+        });
+
+        // Expand the full LOD back into the stream the parser produces
+        VertexIndexInfo info{stream_arena};
+        info.load_model(temp_arena, path);
+        const uint32_t full_index_count = info.lods[0].index_count;
+        DynArray<Vertex> unindexed_vertices{stream_arena};
+        unindexed_vertices.reserve(full_index_count);
+        for (uint32_t i = 0; i < full_index_count; i++) {
+            unindexed_vertices.push_back(info.vertices[info.indices[i]]);
+        }
+        snprintf(variant, sizeof(variant), "%s unordered_map", model_name);
+        runner.run("vertex_weld", variant, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                VertexIndexInfo welded{model_arena};
+                weld_with_unordered_map(temp_arena, welded, unindexed_vertices.data(), unindexed_vertices.size());
+                do_not_optimize(welded.vertices.size());
+                temp_arena.clear();
+                model_arena.clear();
+            }
+        });
+        snprintf(variant, sizeof(variant), "%s flat", model_name);
+        runner.run("vertex_weld", variant, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                VertexIndexInfo welded{model_arena};
+                welded.weld(temp_arena, unindexed_vertices.data(), unindexed_vertices.size());
+                do_not_optimize(welded.vertices.size());
+                temp_arena.clear();
+                model_arena.clear();
+            }
+        });
+        snprintf(variant, sizeof(variant), "%s flat epsilon", model_name);
+        runner.run("vertex_weld", variant, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                VertexIndexInfo welded{model_arena};
+                welded.weld(temp_arena, unindexed_vertices.data(), unindexed_vertices.size(), 1e-5f);
+                do_not_optimize(welded.vertices.size());
+                temp_arena.clear();
+                model_arena.clear();
+            }
+        });
+
+        // Welded but still in OBJ order, what optimize starts from
+        if (runner.should_run("mesh_optimize")) {
+            VertexIndexInfo raw{stream_arena};
+            {
+                engine::assets::MappedFile file;
+                file.open(path);
+                engine::assets::ObjStreams streams{temp_arena};
+                engine::assets::parse_obj(reinterpret_cast<const char*>(file.data()), file.size(), streams);
+                raw.build_from_obj(temp_arena, streams);
+                temp_arena.clear();
+            }
+            for (const bool sort_for_overdraw : {false, true}) {
+                snprintf(variant, sizeof(variant), "%s%s", model_name, sort_for_overdraw ? " overdraw" : "");
+                runner.run("mesh_optimize", variant, [&](uint64_t iterations) {
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        VertexIndexInfo optimized{model_arena};
+                        optimized.vertices.push_back_range(raw.vertices.data(), raw.vertices.size());
+                        optimized.indices.push_back_range(raw.indices.data(), raw.indices.size());
+                        optimized.optimize(temp_arena, sort_for_overdraw);
+                        do_not_optimize(optimized.indices.data());
+                        temp_arena.clear();
+                        model_arena.clear();
+                    }
+                });
+            }
+            VertexIndexInfo optimized{model_arena};
+            optimized.vertices.push_back_range(raw.vertices.data(), raw.vertices.size());
+            optimized.indices.push_back_range(raw.indices.data(), raw.indices.size());
+            optimized.optimize(temp_arena);
+            fprintf(stderr, "%s ACMR %.3f -> %.3f\n", model_name,
+                engine::assets::get_acmr(temp_arena, raw.indices.data(), raw.indices.size(), raw.vertices.size(), engine::assets::VERTEX_CACHE_SIZE),
+                engine::assets::get_acmr(temp_arena, optimized.indices.data(), optimized.indices.size(), optimized.vertices.size(), engine::assets::VERTEX_CACHE_SIZE));
+            temp_arena.clear();
+            model_arena.clear();
+        }
+
+        // The whole LOD chain from the optimized full mesh
+        runner.run("mesh_simplify", model_name, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                VertexIndexInfo simplified{model_arena};
+                simplified.vertices.push_back_range(info.vertices.data(), info.vertices.size());
+                simplified.indices.push_back_range(info.indices.data(), full_index_count);
+                simplified.generate_lods(temp_arena);
+                do_not_optimize(simplified.indices.data());
+                temp_arena.clear();
+                model_arena.clear();
+            }
+        });
+        if (runner.should_run("mesh_simplify")) {
+            fprintf(stderr, "%s LOD triangles", model_name);
+            for (const VulkanModel::MeshLod& lod : info.lods) {
+                fprintf(stderr, " %u", lod.index_count / 3);
+            }
+            fprintf(stderr, "\n");
+        }
+
+        // Meshlets and their bounds for the full LOD
+        runner.run("meshlet_build", model_name, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                DynArray<engine::assets::Meshlet> meshlets{model_arena};
+                DynArray<uint32_t> meshlet_vertices{model_arena};
+                DynArray<uint8_t> meshlet_triangles{model_arena};
+                engine::assets::build_meshlets(temp_arena, info.indices.data(), full_index_count, &info.vertices.data()->position.x, sizeof(Vertex), info.vertices.size(),
+                    meshlets, meshlet_vertices, meshlet_triangles);
+                do_not_optimize(meshlets.data());
+                temp_arena.clear();
+                model_arena.clear();
+            }
+        });
+        if (runner.should_run("meshlet_build")) {
+            const VulkanModel::MeshLod& full = info.lods[0];
+            fprintf(stderr, "%s %u meshlets, %.1f triangles each\n", model_name, full.meshlet_count,
+                static_cast<float>(full.index_count / 3) / static_cast<float>(full.meshlet_count));
+        }
+
+        // Staging cost of each vertex format, the variant names its bytes
+        constexpr std::pair<engine::vulkan::VertexFormat, const char*> vertex_formats[] = {
+            {engine::vulkan::VertexFormat::FLOAT, "float"},
+            {engine::vulkan::VertexFormat::QUANTIZED, "quantized"},
+            {engine::vulkan::VertexFormat::QUANTIZED_STRIPPED, "stripped"},
+        };
+        for (const auto& [format, format_name] : vertex_formats) {
+            const VulkanModel::MeshData mesh = info.get_mesh_data();
+            const size_t encoded_size = static_cast<size_t>(engine::vulkan::get_vertex_stride(format)) * mesh.vertex_count;
+            snprintf(variant, sizeof(variant), "%s %s %zu bytes", model_name, format_name, encoded_size);
+            void* encoded = temp_arena.push(encoded_size);
+            runner.run("vertex_encode", variant, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    do_not_optimize(VulkanModel::encode_vertices(mesh, format, encoded));
+                }
+            });
+            temp_arena.clear();
+        }
+
+        // Mapping, validating and checksumming the cooked file, everything
+        // load_model does before the staging copy
+        char cooked_path[1024];
+        if (engine::assets::get_cooked_path(path, cooked_path, sizeof(cooked_path)) &&
+            engine::assets::write_cooked_mesh(temp_arena, cooked_path, info.get_mesh_data(), path)) {
+            runner.run("cooked_load", model_name, [&](uint64_t iterations) {
+                for (uint64_t i = 0; i < iterations; i++) {
+                    engine::assets::CookedMesh cooked_mesh;
+                    [[maybe_unused]] const bool is_open = cooked_mesh.open(cooked_path, path);
+                    assert(is_open && "Cooked mesh failed to load");
+                    do_not_optimize(cooked_mesh.get_mesh_data().vertices);
+                }
+            });
+        }
+        temp_arena.clear();
+        stream_arena.clear();
+    }
+
+    // Longest the frame loop stalls while every model comes in. Blocking
+    // loads stall for all of them at once, streamed ones only for a tick.
+    if (runner.should_run("model_stream")) {
+        char paths[std::size(model_names)][512];
+        size_t path_count = 0;
+        for (const char* model_name : model_names) {
+            snprintf(paths[path_count], sizeof(paths[path_count]), "%s/%s", models_directory, model_name);
+            if (FILE* file = fopen(paths[path_count], "rb")) {
+                fclose(file);
+                path_count++;
+            }
+        }
+        runner.measure("model_stream", "blocking load_model", 1, BenchmarkRunner::SAMPLE_COUNT, [&] {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < path_count; i++) {
+                const VulkanModel model = VulkanModel::load_model(temp_arena, model_arena, nullptr, VK_NULL_HANDLE, paths[i], &job_system);
+                do_not_optimize(model.get_lod_count());
+                temp_arena.clear();
+                model_arena.clear();
+            }
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        });
+        // With a single thread tick() runs the decodes itself
+        char variant[128];
+        snprintf(variant, sizeof(variant), "async longest tick x%u", job_system.get_thread_count());
+        runner.measure("model_stream", variant, 1, BenchmarkRunner::SAMPLE_COUNT, [&] {
+            Arena loader_arena{job_arena_size};
+            engine::tasks::TaskExecutor task_executor{loader_arena, job_system};
+            engine::assets::AssetLoader asset_loader{loader_arena, task_executor, job_system, nullptr, VK_NULL_HANDLE,
+                engine::vulkan::VertexFormat::FLOAT, static_cast<uint32_t>(path_count)};
+            engine::assets::ModelHandle handles[std::size(model_names)];
+            const auto request_start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < path_count; i++) {
+                handles[i] = asset_loader.request_model(paths[i]);
+            }
+            double longest_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - request_start).count();
+            while (!std::all_of(handles, handles + path_count, [&](engine::assets::ModelHandle handle) { return asset_loader.is_done(handle); })) {
+                const auto start = std::chrono::steady_clock::now();
+                task_executor.tick();
+                longest_ns = std::max(longest_ns, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+            }
+            return longest_ns;
+        });
+    }
+
+    if (!runner.should_run("obj_parse")) {
+        return;
+    }
+    const std::string grid = make_grid_obj(grid_size);
+    char variant[128];
+    snprintf(variant, sizeof(variant), "grid_%d serial", grid_size);
+    runner.run("obj_parse", variant, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            engine::assets::ObjStreams streams{temp_arena};
+            engine::assets::parse_obj(grid.data(), grid.size(), streams);
+            do_not_optimize(streams.corners.data());
+            temp_arena.clear();
+        }
+    });
+    snprintf(variant, sizeof(variant), "grid_%d parallel x%u", grid_size, job_system.get_thread_count());
+    runner.run("obj_parse", variant, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            engine::assets::ObjStreams streams{temp_arena};
+            engine::assets::parse_obj_parallel(job_system, grid.data(), grid.size(), streams);
+            do_not_optimize(streams.corners.data());
+            temp_arena.clear();
+        }
+    });
+}
+
+}
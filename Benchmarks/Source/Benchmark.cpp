@@ -0,0 +1,24 @@
+#include "Benchmark.h"
+
+#include <cstring>
+
+namespace benchmarks {
+
+BenchmarkRunner::BenchmarkRunner(FILE* output, const char* filter) : m_output_(output), m_filter_(filter) {
+    
+}
+
+bool BenchmarkRunner::should_run(const char* name) const {
+    return m_filter_ == nullptr || strncmp(name, m_filter_, strlen(m_filter_)) == 0;
+}
+
+void BenchmarkRunner::write_header() const {
+    fprintf(m_output_, "benchmark,variant,iterations,median_ns,min_ns\n");
+}
+
+void BenchmarkRunner::report(const char* name, const char* variant, uint64_t iterations, double median_ns, double min_ns) const {
+    fprintf(m_output_, "%s,%s,%llu,%.3f,%.3f\n", name, variant, static_cast<unsigned long long>(iterations), median_ns, min_ns);
+    fflush(m_output_);
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace benchmarks {
+
+// Keeps the optimizer from deleting work whose result is never used
+template <typename T>
+void do_not_optimize(const T& value) {
+#if defined(_MSC_VER)
+    const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+    (void)*sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+// Runs benchmarks and writes one CSV row per benchmark and variant:
+// benchmark,variant,iterations,median_ns,min_ns with times per operation.
+class BenchmarkRunner {
+public:
+    static constexpr int SAMPLE_COUNT = 7;
+    static constexpr double MIN_SAMPLE_NS = 10'000'000.0;
+private:
+    FILE* m_output_;
+    const char* m_filter_;
+public:
+    BenchmarkRunner(FILE* output, const char* filter);
+
+    // True if the name starts with the filter. Benchmarks with expensive
+    // setup check this before doing it.
+    [[nodiscard]] bool should_run(const char* name) const;
+    void write_header() const;
+    void report(const char* name, const char* variant, uint64_t iterations, double median_ns, double min_ns) const;
+
+    // sample() does operations_per_sample operations and returns how long
+    // that took in nanoseconds
+    template <typename Sample>
+    void measure(const char* name, const char* variant, uint64_t operations_per_sample, int sample_count, Sample&& sample) const;
+    // run(iterations) does iterations operations. The count doubles until one
+    // call takes MIN_SAMPLE_NS, then SAMPLE_COUNT calls are timed.
+    template <typename Fn>
+    void run(const char* name, const char* variant, Fn&& fn) const;
+};
+
+template <typename Sample>
+void BenchmarkRunner::measure(const char* name, const char* variant, uint64_t operations_per_sample, int sample_count, Sample&& sample) const {
+    if (!should_run(name)) {
+        return;
+    }
+    double samples[SAMPLE_COUNT];
+    sample_count = std::clamp(sample_count, 1, SAMPLE_COUNT);
+    for (int i = 0; i < sample_count; i++) {
+        samples[i] = sample() / static_cast<double>(operations_per_sample);
+    }
+    std::sort(samples, samples + sample_count);
+    report(name, variant, operations_per_sample, samples[sample_count / 2], samples[0]);
+}
+
+template <typename Fn>
+void BenchmarkRunner::run(const char* name, const char* variant, Fn&& fn) const {
+    if (!should_run(name)) {
+        return;
+    }
+    const auto time_ns = [&](uint64_t iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        fn(iterations);
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    };
+    uint64_t iterations = 1;
+    while (time_ns(iterations) < MIN_SAMPLE_NS && iterations < (1ull << 32)) {
+        iterations *= 2;
+    }
+    measure(name, variant, iterations, SAMPLE_COUNT, [&] {
+        return time_ns(iterations);
+    });
+}
+
+void run_memory_benchmarks(const BenchmarkRunner& runner);
+void run_ecs_benchmarks(const BenchmarkRunner& runner);
+void run_ecs_threading_benchmarks(const BenchmarkRunner& runner);
+void run_asset_benchmarks(const BenchmarkRunner& runner, const char* models_directory);
+void run_scene_benchmarks(const BenchmarkRunner& runner);
+
+}
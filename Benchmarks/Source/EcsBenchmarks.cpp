@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+
+#include "Engine/ECS/EntityLookupTable.h"
+#include "Engine/ECS/Components/Components.h"
+#include "Memory/Arena.h"
+
+namespace benchmarks {
+
+namespace {
+
+constexpr size_t table_arena_size = 1 << 27;
+constexpr ecs::entity_t prefilled_entities = 100000;
+
+}
+
+void run_ecs_benchmarks(const BenchmarkRunner& runner) {
+    const ecs::component_set components{0b11};
+
+    {
+        // Arenas are reused so only the table's own work is timed
+        Arena temp_arena{1 << 20};
+        Arena ecs_arena{table_arena_size};
+
+        runner.run("entity_lookup_table_insert", "fresh_table", [&](uint64_t iterations) {
+            temp_arena.clear();
+            ecs_arena.clear();
+            ecs::EntityLookupTable table{&temp_arena, &ecs_arena};
+            for (uint64_t i = 0; i < iterations; i++) {
+                table.insert(i, components);
+            }
+            do_not_optimize(table.get_size());
+        });
+
+        runner.run("entity_lookup_table_insert", "insert_range", [&](uint64_t iterations) {
+            temp_arena.clear();
+            ecs_arena.clear();
+            ecs::EntityLookupTable table{&temp_arena, &ecs_arena};
+            table.insert_range({0, iterations}, components);
+            do_not_optimize(table.get_size());
+        });
+    }
+
+    {
+        Arena temp_arena{1 << 20};
+        Arena ecs_arena{table_arena_size};
+        ecs::EntityLookupTable table{&temp_arena, &ecs_arena};
+        table.insert_range({0, prefilled_entities}, components);
+
+        runner.run("entity_lookup_table_contains", "100k", [&](uint64_t iterations) {
+            size_t found = 0;
+            for (uint64_t i = 0; i < iterations; i++) {
+                // Every other lookup misses
+                found += table.contains(i % (prefilled_entities * 2));
+            }
+            do_not_optimize(found);
+        });
+
+        runner.run("entity_lookup_table_remove_insert", "100k", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                const ecs::entity_t entity = i % prefilled_entities;
+                table.remove(entity);
+                table.insert(entity, components);
+            }
+        });
+    }
+
+    {
+        components::Transform3D transforms[1024];
+        for (size_t i = 0; i < 1024; i++) {
+            const float value = static_cast<float>(i) * 0.01f;
+            transforms[i] = {.translation = {value, -value, 2.5f}, .rotation = {value, value * 2.f, value * 0.5f}, .scale = glm::vec3{.5f}};
+        }
+        runner.run("transform_as_matrix", "1024", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                const glm::mat4 matrix = transforms[i % 1024].as_matrix();
+                do_not_optimize(matrix);
+            }
+        });
+    }
+}
+
+}
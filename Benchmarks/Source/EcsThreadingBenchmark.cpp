@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Benchmark.h"
+#include "Engine/ECS/FlecsBulk.h"
+#include "Engine/Systems/CoreEngineSystems.h"
+#include "Engine/Vulkan/Camera.h"
+#include "Engine/Vulkan/VulkanModel.h"
+#include "Memory/Arena.h"
+
+// Frame time of the engine's CPU side systems (transforms and draw packet
+// building) against the number of flecs worker threads. Recording is left out
+// since it needs a device, the packets it would read are all built here.
+
+namespace benchmarks {
+
+namespace {
+
+constexpr int warmup_frames = 10;
+constexpr int measured_frames = 100;
+constexpr int samples = 3;
+
+struct Velocity {
+    glm::vec3 direction;
+    float speed;
+};
+
+void measure_frame_time(const BenchmarkRunner& runner, int32_t cube_count, int32_t thread_count) {
+    flecs::world world;
+    if (thread_count > 1) {
+        world.set_threads(thread_count);
+    }
+    systems::register_components(world);
+    world.emplace<Camera>(glm::radians(45.0f), 1.25f, 0.1f, 10.f);
+
+    world.system<components::Transform3D, const Velocity>()
+        .kind(flecs::OnUpdate)
+        .multi_threaded()
+        .each([](flecs::iter& it, size_t, components::Transform3D& transform, const Velocity& velocity) {
+            constexpr float rotation_speed = 0.5f;
+            const float delta_time = it.delta_time();
+            transform.rotation.x = glm::mod(transform.rotation.x + delta_time * rotation_speed, glm::two_pi<float>());
+            transform.translation += velocity.speed * velocity.direction * delta_time;
+        });
+    systems::setup_transform_system(world);
+    systems::setup_draw_packet_system(world);
+
+    // Headless model, so the draw packet system selects LODs like a real scene
+    Arena model_arena{1 << 20};
+    engine::vulkan::VulkanModel::VertexIndexInfo quad{model_arena};
+    for (const glm::vec3 position : {glm::vec3{-1.f, -1.f, 0.f}, glm::vec3{1.f, -1.f, 0.f}, glm::vec3{1.f, 1.f, 0.f}, glm::vec3{-1.f, 1.f, 0.f}}) {
+        quad.vertices.push_back({.position = position, .color = {1.f, 1.f, 1.f}, .normal = {0.f, 0.f, -1.f}, .uv = {}});
+    }
+    for (const uint32_t index : {0u, 1u, 2u, 2u, 3u, 0u}) {
+        quad.indices.push_back(index);
+    }
+    engine::vulkan::VulkanModel model{nullptr, VK_NULL_HANDLE, quad};
+
+    const flecs::entity prefab = world.prefab();
+    auto* transforms = new components::Transform3D[cube_count];
+    auto* renderables = new components::Renderable[cube_count];
+    auto* velocities = new Velocity[cube_count];
+    for (int32_t i = 0; i < cube_count; i++) {
+        transforms[i] = {.translation = {0.f, 0.f, 2.5f}, .rotation = {0.f, 0.f, 0.f}, .scale = glm::vec3{.5f}};
+        renderables[i] = {&model};
+        velocities[i] = {.direction = glm::vec3{1.f, 0.f, 0.f}, .speed = .5f};
+    }
+    ecs::bulk_create(world, cube_count, prefab, transforms, renderables, velocities);
+    delete[] transforms;
+    delete[] renderables;
+    delete[] velocities;
+
+    for (int frame = 0; frame < warmup_frames; frame++) {
+        world.progress(1.f / 60.f);
+    }
+    char variant[64];
+    snprintf(variant, sizeof(variant), "cubes=%d threads=%d", cube_count, thread_count);
+    runner.measure("ecs_frame", variant, measured_frames, samples, [&] {
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < measured_frames; frame++) {
+            world.progress(1.f / 60.f);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    });
+}
+
+}
+
+void run_ecs_threading_benchmarks(const BenchmarkRunner& runner) {
+    if (!runner.should_run("ecs_frame")) {
+        return;
+    }
+    const int32_t max_threads = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    constexpr int32_t cube_counts[] = {10000, 50000, 100000};
+    for (const int32_t cube_count : cube_counts) {
+        for (int32_t thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+            measure_frame_time(runner, cube_count, thread_count);
+        }
+    }
+}
+
+}
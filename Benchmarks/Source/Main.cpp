@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "Engine/Engine.h"
+
+// Usage: Benchmarks [--filter name_prefix] [--out results.csv] [--models directory]
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* output_path = nullptr;
+    const char* models_directory = "../Game/Models";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--filter") == 0) {
+            filter = argv[i + 1];
+        } else if (strcmp(argv[i], "--out") == 0) {
+            output_path = argv[i + 1];
+        } else if (strcmp(argv[i], "--models") == 0) {
+            models_directory = argv[i + 1];
+        }
+    }
+
+    // Printing every allocation would swamp anything that touches the heap
+    engine::set_allocation_logging(false);
+    FILE* output = output_path != nullptr ? fopen(output_path, "w") : stdout;
+    if (output == nullptr) {
+        fprintf(stderr, "Failed to open %s\n", output_path);
+        return 1;
+    }
+
+    const benchmarks::BenchmarkRunner runner{output, filter};
+    runner.write_header();
+    benchmarks::run_memory_benchmarks(runner);
+    benchmarks::run_ecs_benchmarks(runner);
+    benchmarks::run_asset_benchmarks(runner, models_directory);
+    benchmarks::run_ecs_threading_benchmarks(runner);
+    benchmarks::run_scene_benchmarks(runner);
+
+    if (output != stdout) {
+        fclose(output);
+    }
+}
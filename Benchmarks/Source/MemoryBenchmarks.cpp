@@ -0,0 +1,114 @@
+#include "Benchmark.h"
+
+#include "Containers/DynArray.h"
+#include "Memory/Arena.h"
+#include "Memory/Allocators/PoolAllocator.h"
+#include "Memory/Allocators/StackAllocator.h"
+
+namespace benchmarks {
+
+namespace {
+
+constexpr size_t arena_size = 1 << 26;
+// Pushes between clears, small enough that every size stays inside the arena
+constexpr uint64_t pushes_per_clear = 4096;
+
+void run_arena_push(const BenchmarkRunner& runner, const char* variant, size_t size, size_t alignment) {
+    Arena arena{arena_size};
+    runner.run("arena_push", variant, [&](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; i++) {
+            do_not_optimize(arena.push(size, alignment));
+            if (i % pushes_per_clear == pushes_per_clear - 1) {
+                arena.clear();
+            }
+        }
+        arena.clear();
+    });
+}
+
+}
+
+void run_memory_benchmarks(const BenchmarkRunner& runner) {
+    run_arena_push(runner, "16B", 16, 8);
+    run_arena_push(runner, "64B", 64, 16);
+    run_arena_push(runner, "256B_align64", 256, 64);
+
+    {
+        allocators::StackAllocator stack{arena_size};
+        runner.run("stack_allocator_allocate", "64B", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                do_not_optimize(stack.allocate(64));
+                if (i % pushes_per_clear == pushes_per_clear - 1) {
+                    stack.clear();
+                }
+            }
+            stack.clear();
+        });
+    }
+
+    {
+        Arena arena{arena_size};
+        engine::allocators::PoolAllocator pool{&arena, 1024, 64};
+        runner.run("pool_allocator", "allocate_free", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i++) {
+                void* chunk = pool.allocate();
+                do_not_optimize(chunk);
+                pool.deallocate(chunk);
+            }
+        });
+        void* chunks[1024];
+        runner.run("pool_allocator", "batch_1024", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i += 1024) {
+                for (void*& chunk : chunks) {
+                    chunk = pool.allocate();
+                }
+                do_not_optimize(chunks);
+                for (void* chunk : chunks) {
+                    pool.deallocate(chunk);
+                }
+            }
+        });
+    }
+
+    {
+        Arena arena{arena_size};
+        runner.run("dynarray_push_back", "grow", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i += 1024) {
+                DynArray<uint32_t> array{arena};
+                for (uint32_t j = 0; j < 1024; j++) {
+                    array.push_back(j);
+                }
+                do_not_optimize(array.data());
+                arena.clear();
+            }
+        });
+        runner.run("dynarray_push_back", "reserved", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i += 1024) {
+                DynArray<uint32_t> array{arena};
+                array.reserve(1024);
+                for (uint32_t j = 0; j < 1024; j++) {
+                    array.push_back(j);
+                }
+                do_not_optimize(array.data());
+                arena.clear();
+            }
+        });
+
+        DynArray<uint32_t> array{arena};
+        array.reserve(1 << 20);
+        for (uint32_t j = 0; j < 1 << 20; j++) {
+            array.push_back(j);
+        }
+        runner.run("dynarray_iterate", "1M_u32", [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; i += array.size()) {
+                uint64_t sum = 0;
+                for (const uint32_t value : array) {
+                    sum += value;
+                }
+                do_not_optimize(sum);
+            }
+        });
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Benchmark.h"
+#include "Engine/Engine.h"
+#include "Engine/ECS/FlecsBulk.h"
+#include "Engine/Vulkan/Camera.h"
+
+// Whole frame loop of a headless engine: task tick, progress with the game's
+// systems and the render list build. Frames record nothing without a device.
+
+namespace benchmarks {
+
+namespace {
+
+constexpr uint64_t scene_frames = 300;
+constexpr int samples = 3;
+
+struct Velocity {
+    glm::vec3 direction;
+    float speed;
+};
+
+double run_scene(int32_t cube_count) {
+    const int32_t thread_count = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    engine::StealthEngine engine{{.ecs_threads = thread_count, .headless = true, .frame_limit = scene_frames}};
+    flecs::world& world = engine.get_world();
+    world.emplace<Camera>(glm::radians(45.0f), engine.get_aspect_ratio(), 0.1f, 10.f);
+
+    Arena model_arena{1 << 20};
+    engine::vulkan::VulkanModel::VertexIndexInfo quad{model_arena};
+    for (const glm::vec3 position : {glm::vec3{-1.f, -1.f, 0.f}, glm::vec3{1.f, -1.f, 0.f}, glm::vec3{1.f, 1.f, 0.f}, glm::vec3{-1.f, 1.f, 0.f}}) {
+        quad.vertices.push_back({.position = position, .color = {1.f, 1.f, 1.f}, .normal = {0.f, 0.f, -1.f}, .uv = {}});
+    }
+    for (const uint32_t index : {0u, 1u, 2u, 2u, 3u, 0u}) {
+        quad.indices.push_back(index);
+    }
+    engine::vulkan::VulkanModel model = engine.create_model(quad);
+
+    world.system<components::Transform3D, const Velocity>()
+        .kind(flecs::OnUpdate)
+        .multi_threaded()
+        .each([](flecs::iter& it, size_t, components::Transform3D& transform, const Velocity& velocity) {
+            const float delta_time = it.delta_time();
+            transform.rotation.y = glm::mod(transform.rotation.y + delta_time, glm::two_pi<float>());
+            transform.translation += velocity.speed * velocity.direction * delta_time;
+        });
+
+    const flecs::entity prefab = world.prefab();
+    auto* transforms = new components::Transform3D[cube_count];
+    auto* renderables = new components::Renderable[cube_count];
+    auto* velocities = new Velocity[cube_count];
+    for (int32_t i = 0; i < cube_count; i++) {
+        transforms[i] = {.translation = {0.f, 0.f, 2.5f}, .rotation = {0.f, 0.f, 0.f}, .scale = glm::vec3{.5f}};
+        renderables[i] = {&model};
+        velocities[i] = {.direction = glm::vec3{1.f, 0.f, 0.f}, .speed = .01f};
+    }
+    ecs::bulk_create(world, cube_count, prefab, transforms, renderables, velocities);
+    delete[] transforms;
+    delete[] renderables;
+    delete[] velocities;
+
+    const auto start = std::chrono::steady_clock::now();
+    engine.run();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+void run_scene_benchmarks(const BenchmarkRunner& runner) {
+    constexpr int32_t cube_counts[] = {1000, 10000};
+    for (const int32_t cube_count : cube_counts) {
+        char variant[32];
+        snprintf(variant, sizeof(variant), "cubes=%d", cube_count);
+        runner.measure("headless_scene_frame", variant, scene_frames, samples, [&] {
+            return run_scene(cube_count);
+        });
+    }
+}
+
+}
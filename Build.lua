@@ -20,4 +20,5 @@ group "Engine"
 group ""
 
 include "Dependencies.lua"
-include "Game/Build-Game.lua"
\ No newline at end of file
+include "Game/Build-Game.lua"
+include "Benchmarks/Build-Benchmarks.lua"
\ No newline at end of file
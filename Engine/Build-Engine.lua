@@ -21,22 +21,31 @@ project "Engine"
         "TINYOBJLOADER_IMPLEMENTATION"
    }
 
-   links { vulkanSDKPath .. "/Lib/vulkan-1.lib", "GLFW" }
-
    includedirs
    {
       "Source",
-      vulkanSDKPath .. "/Include",
       "Vendor/glfw/include",
       "Vendor/glm/glm"
    }
 
+   -- Linux distributions install the Vulkan headers system wide
+   if vulkanSDKPath then
+      includedirs { vulkanSDKPath .. "/Include" }
+   end
+
    targetdir ("../Binaries/" .. outputdir .. "/%{prj.name}")
    objdir ("../Binaries/Intermediates/" .. outputdir .. "/%{prj.name}")
 
    filter "system:windows"
        systemversion "latest"
        defines { }
+       links { "GLFW" }
+       if vulkanSDKPath then
+          links { vulkanSDKPath .. "/Lib/vulkan-1.lib" }
+       end
+
+   filter "system:linux"
+       links { "vulkan", "glfw", "pthread", "dl" }
 
    filter "configurations:Debug"
        defines { "DEBUG" }
@@ -60,6 +69,6 @@ project "Engine"
       shadermodel "5.0"
    filter { "files:**.frag" }
       removeflags "ExcludeFromBuild"
-      shadertype "Fragment"
+      shadertype "Pixel"
       shaderentry "ForFragment"
     filter {}
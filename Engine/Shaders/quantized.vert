@@ -0,0 +1,31 @@
+#version 450
+
+// Vertex layout of VertexFormat::QUANTIZED. Positions arrive as unorm
+// fractions of the mesh bounds, the transform scales them back.
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in vec2 octahedralNormal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec2 fragUv;
+
+layout(push_constant) uniform Push {
+    mat4 transform;
+} push;
+
+vec3 decodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
+
+void main() {
+    gl_Position = push.transform * vec4(position, 1.0);
+    fragColor = color;
+    fragNormal = decodeOctahedral(octahedralNormal);
+    fragUv = uv;
+}
\ No newline at end of file
@@ -125,6 +125,7 @@ public:
 
     [[nodiscard]] bool is_empty() const;
     void resize(size_t size);
+    void reserve(size_t capacity);
     [[nodiscard]] size_t size() const;
     T* data() const;
     void clear();
@@ -132,6 +133,10 @@ public:
     T& operator[](size_t index) const;
     T& operator[](size_t index);
     void push_back(const T& value);
+    // Bulk appends. Capacity is grown once for the whole range.
+    void push_back_n(const T& value, size_t count);
+    void push_back_range(const T* values, size_t count);
+    void pop_back();
 
     iterator begin();
     const_iterator begin() const;
@@ -237,6 +242,18 @@ void DynArray<T>::resize(const size_t new_capacity) {
     // Pop old data off. However, using stack allocator here
 }
 
+template <typename T>
+void DynArray<T>::reserve(size_t capacity) {
+    if (capacity <= m_capacity_) {
+        return;
+    }
+    size_t new_capacity = m_capacity_ == 0 ? 32 : m_capacity_;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+    resize(new_capacity);
+}
+
 template<typename T>
 size_t DynArray<T>::size() const {
     return m_size_;
@@ -251,6 +268,7 @@ template <typename T>
 void DynArray<T>::clear() {
     m_data_ptr_ = nullptr;
     m_size_ = 0;
+    m_capacity_ = 0;
 }
 
 template<typename T>
@@ -276,6 +294,27 @@ void DynArray<T>::push_back(const T& value) {
     m_data_ptr_[m_size_++] = value;
 }
 
+template <typename T>
+void DynArray<T>::push_back_n(const T& value, size_t count) {
+    reserve(m_size_ + count);
+    std::fill_n(m_data_ptr_ + m_size_, count, value);
+    m_size_ += count;
+}
+
+template <typename T>
+void DynArray<T>::push_back_range(const T* values, size_t count) {
+    reserve(m_size_ + count);
+    std::copy_n(values, count, m_data_ptr_ + m_size_);
+    m_size_ += count;
+}
+
+template <typename T>
+void DynArray<T>::pop_back() {
+    if (m_size_ > 0) {
+        m_size_--;
+    }
+}
+
 template<typename T>
 typename DynArray<T>::iterator DynArray<T>::begin() {
     return DynArray::iterator(this, 0);
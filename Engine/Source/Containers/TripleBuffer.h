@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "ObjectHolder.h"
+
+// Single producer, single consumer hand off. The writer always has a buffer to
+// fill and the reader always has the newest complete one, neither ever waits
+// on the other. Buffers that the reader skips are recycled.
+template <typename T>
+class TripleBuffer {
+    static constexpr uint8_t index_mask = 0b011;
+    static constexpr uint8_t fresh_bit = 0b100;
+
+    ObjectHolder<T> m_buffers_[3];
+    uint8_t m_back_;
+    std::atomic<uint8_t> m_middle_;
+    uint8_t m_front_;
+public:
+    template <typename... Args>
+    explicit TripleBuffer(const Args&... args);
+    ~TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+    TripleBuffer(TripleBuffer&&) = delete;
+    TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+    // Writer side
+    T& get_back();
+    void publish();
+
+    // Reader side. Swaps in the newest published buffer, false if nothing was
+    // published since the last call.
+    bool acquire();
+    const T& get_front() const;
+};
+
+template <typename T>
+template <typename... Args>
+TripleBuffer<T>::TripleBuffer(const Args&... args) : m_back_(0), m_middle_(1), m_front_(2) {
+    for (ObjectHolder<T>& buffer : m_buffers_) {
+        buffer.emplace(args...);
+    }
+}
+
+template <typename T>
+T& TripleBuffer<T>::get_back() {
+    return *m_buffers_[m_back_];
+}
+
+template <typename T>
+void TripleBuffer<T>::publish() {
+    m_back_ = m_middle_.exchange(m_back_ | fresh_bit, std::memory_order_acq_rel) & index_mask;
+}
+
+template <typename T>
+bool TripleBuffer<T>::acquire() {
+    if ((m_middle_.load(std::memory_order_relaxed) & fresh_bit) == 0) {
+        return false;
+    }
+    m_front_ = m_middle_.exchange(m_front_, std::memory_order_acq_rel) & index_mask;
+    return true;
+}
+
+template <typename T>
+const T& TripleBuffer<T>::get_front() const {
+    return *m_buffers_[m_front_];
+}
@@ -0,0 +1,223 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+#include "CookedMesh.h"
+#include "Engine/Profiling/Profiler.h"
+
+namespace engine::assets {
+
+namespace {
+
+constexpr size_t page_size = 4096;
+// First block of each decode arena, later blocks double. A model that
+// needs more takes a handful of blocks instead of a worst case reservation.
+constexpr size_t min_decode_block_size = 1 << 20;
+
+}
+
+AssetLoader::AssetLoader(Arena& permanent_arena, tasks::TaskExecutor& task_executor, jobs::JobSystem& job_system, vulkan::DeviceWrapper* device, VkCommandPool command_pool,
+    vulkan::VertexFormat vertex_format, uint32_t max_models) : m_task_executor_(&task_executor), m_job_system_(&job_system),
+    m_device_(device), m_command_pool_(command_pool), m_vertex_format_(vertex_format),
+    m_slots_(static_cast<ModelSlot*>(permanent_arena.push(sizeof(ModelSlot) * max_models, alignof(ModelSlot)))),
+    m_slot_capacity_(max_models), m_slot_count_(0), m_placeholder_(nullptr),
+    m_read_head_(nullptr), m_read_tail_(nullptr), m_is_stopping_(false) {
+    if (m_slots_ == nullptr) {
+        throw std::runtime_error("Permanent arena is too small for the asset loader");
+    }
+    for (uint32_t i = 0; i < max_models; i++) {
+        new (&m_slots_[i]) ModelSlot{};
+    }
+    m_io_thread_ = std::thread(&AssetLoader::io_loop, this);
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard lock(m_read_mutex_);
+        m_is_stopping_ = true;
+    }
+    m_read_condition_.notify_one();
+    m_io_thread_.join();
+    // Workers still write into the frames of decoding loads, which the task
+    // executor frees after this
+    m_job_system_->wait(m_decode_counter_);
+    for (uint32_t i = 0; i < m_slot_capacity_; i++) {
+        m_slots_[i].~ModelSlot();
+    }
+}
+
+void AssetLoader::io_loop() {
+    while (true) {
+        ReadRequest* request;
+        {
+            std::unique_lock lock(m_read_mutex_);
+            m_read_condition_.wait(lock, [this] {
+                return m_is_stopping_ || m_read_head_ != nullptr;
+            });
+            // Queued reads are dropped, their tasks stay suspended until the
+            // executor frees them
+            if (m_is_stopping_) {
+                return;
+            }
+            request = m_read_head_;
+            m_read_head_ = request->next;
+            if (m_read_head_ == nullptr) {
+                m_read_tail_ = nullptr;
+            }
+        }
+
+        PROFILE_ZONE("read_asset");
+        // The cooked copy is what a current cache loads, otherwise the
+        // source gets parsed. Stale cooked files are read for nothing.
+        char cooked_path[1024];
+        request->is_cooked = get_cooked_path(request->file_path, cooked_path, sizeof(cooked_path)) && request->file.open(cooked_path);
+        if (!request->is_cooked) {
+            request->file.open(request->file_path);
+        }
+        // Touching every page faults the whole file in here, so the worker
+        // that decodes it doesn't stall on the disk
+        uint8_t page_sum = 0;
+        for (size_t offset = 0; offset < request->file.size(); offset += page_size) {
+            page_sum += request->file.data()[offset];
+        }
+        request->page_sum = page_sum;
+        m_task_executor_->schedule(&request->node);
+    }
+}
+
+void AssetLoader::queue_read(ReadRequest* request) {
+    request->next = nullptr;
+    {
+        std::lock_guard lock(m_read_mutex_);
+        if (m_read_tail_ != nullptr) {
+            m_read_tail_->next = request;
+        } else {
+            m_read_head_ = request;
+        }
+        m_read_tail_ = request;
+    }
+    m_read_condition_.notify_one();
+}
+
+void AssetLoader::decode(void* data) {
+    const auto request = static_cast<DecodeRequest*>(data);
+    const size_t block_size = std::max(request->file->size(), min_decode_block_size);
+    request->parse_arena.emplace(block_size, Arena::Growth::CHAINED);
+    request->model_arena.emplace(block_size, Arena::Growth::CHAINED);
+    request->vertex_index_info.emplace(*request->model_arena);
+    try {
+        request->mesh = vulkan::VulkanModel::load_mesh_data(*request->parse_arena, *request->file, request->is_cooked, request->file_path,
+            *request->vertex_index_info, request->cooked_mesh, request->job_system);
+    } catch (const std::bad_alloc&) {
+        // An empty mesh fails the load
+        std::cerr << "Out of memory decoding " << request->file_path << "\n";
+        request->mesh = {};
+    }
+    // The mesh lives in the model arena or the cooked file
+    request->parse_arena.reset();
+    request->task_executor->schedule(&request->node);
+}
+
+void AssetLoader::release_decode_memory(void* data) {
+    const auto request = static_cast<DecodeRequest*>(data);
+    request->vertex_index_info.reset();
+    request->model_arena.reset();
+    request->task_executor->schedule(&request->node);
+}
+
+tasks::Task<void> AssetLoader::load(ModelHandle handle) {
+    ModelSlot& slot = m_slots_[handle.index];
+    slot.state.store(LoadState::READING, std::memory_order_relaxed);
+    ReadRequest read_request{};
+    read_request.file_path = slot.file_path;
+    if (!co_await ReadAwaiter{this, &read_request}) {
+        std::cerr << "Failed to open " << slot.file_path << "\n";
+        finish(handle, LoadState::FAILED);
+        co_return;
+    }
+
+    slot.state.store(LoadState::DECODING, std::memory_order_relaxed);
+    DecodeRequest decode_request{};
+    decode_request.task_executor = m_task_executor_;
+    decode_request.job_system = m_job_system_;
+    decode_request.file_path = slot.file_path;
+    decode_request.file = &read_request.file;
+    decode_request.is_cooked = read_request.is_cooked;
+    co_await JobAwaiter{this, &decode_request, &decode};
+    read_request.file.close();
+    const vulkan::VulkanModel::MeshData& mesh = decode_request.mesh;
+    // Same precondition as the VulkanModel constructor
+    if (mesh.vertex_count <= 3) {
+        finish(handle, LoadState::FAILED);
+    } else {
+        slot.state.store(LoadState::UPLOADING, std::memory_order_relaxed);
+        if (m_device_ == nullptr) {
+            slot.model.emplace(m_device_, m_command_pool_, mesh, m_vertex_format_);
+        } else {
+            vulkan::VulkanModel::PendingUpload upload{};
+            slot.model.emplace(m_device_, m_command_pool_, mesh, upload, m_vertex_format_);
+            co_await m_task_executor_->wait_until([&] {
+                return upload.is_complete(*m_device_);
+            });
+            vulkan::VulkanModel::finish_upload(m_device_, m_command_pool_, upload);
+        }
+        finish(handle, LoadState::READY);
+    }
+    co_await JobAwaiter{this, &decode_request, &release_decode_memory};
+}
+
+void AssetLoader::finish(ModelHandle handle, LoadState state) {
+    ModelSlot& slot = m_slots_[handle.index];
+    // Release so other threads that see READY also see the model
+    slot.state.store(state, std::memory_order_release);
+    if (slot.callback != nullptr) {
+        slot.callback(slot.user_data, handle, state == LoadState::READY ? slot.model.get() : nullptr);
+    }
+}
+
+ModelHandle AssetLoader::request_model(const char* file_path, ModelCallback callback, void* user_data) {
+    if (m_slot_count_ == m_slot_capacity_) {
+        throw std::runtime_error("Asset loader is out of model slots");
+    }
+    const ModelHandle handle{m_slot_count_++};
+    ModelSlot& slot = m_slots_[handle.index];
+    slot.state.store(LoadState::QUEUED, std::memory_order_relaxed);
+    slot.file_path = file_path;
+    slot.callback = callback;
+    slot.user_data = user_data;
+    m_task_executor_->spawn(load(handle));
+    return handle;
+}
+
+void AssetLoader::set_placeholder(vulkan::VulkanModel* placeholder) {
+    m_placeholder_ = placeholder;
+}
+
+vulkan::VulkanModel* AssetLoader::get_model(ModelHandle handle) const {
+    assert(handle.index < m_slot_capacity_ && "Unknown model handle");
+    ModelSlot& slot = m_slots_[handle.index];
+    return slot.state.load(std::memory_order_acquire) == LoadState::READY ? slot.model.get() : m_placeholder_;
+}
+
+LoadState AssetLoader::get_state(ModelHandle handle) const {
+    assert(handle.index < m_slot_capacity_ && "Unknown model handle");
+    return m_slots_[handle.index].state.load(std::memory_order_acquire);
+}
+
+bool AssetLoader::is_done(ModelHandle handle) const {
+    const LoadState state = get_state(handle);
+    return state == LoadState::READY || state == LoadState::FAILED;
+}
+
+tasks::Task<vulkan::VulkanModel*> AssetLoader::wait_for(ModelHandle handle) {
+    co_await m_task_executor_->wait_until([this, handle] {
+        return is_done(handle);
+    });
+    co_return get_state(handle) == LoadState::READY ? m_slots_[handle.index].model.get() : nullptr;
+}
+
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "CookedMesh.h"
+#include "MappedFile.h"
+#include "Containers/ObjectHolder.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Engine/Tasks/Task.h"
+#include "Engine/Tasks/TaskExecutor.h"
+#include "Engine/Vulkan/VulkanModel.h"
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+enum class LoadState : uint8_t {
+    QUEUED,
+    READING,
+    DECODING,
+    UPLOADING,
+    READY,
+    FAILED,
+};
+
+struct ModelHandle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+    uint32_t index = INVALID_INDEX;
+
+    [[nodiscard]] bool is_valid() const {
+        return index != INVALID_INDEX;
+    }
+};
+
+// Runs on the frame loop's thread once the load finished, model is nullptr
+// if it failed
+using ModelCallback = void (*)(void* user_data, ModelHandle handle, vulkan::VulkanModel* model);
+
+// Streams models in without stalling the frame loop. A dedicated I/O thread
+// faults the file in, a job system worker parses or validates it and the
+// frame loop records the upload and polls its fence. Each load is a task on
+// the TaskExecutor, so it only ever resumes inside tick().
+class AssetLoader {
+    struct ModelSlot {
+        ObjectHolder<vulkan::VulkanModel> model;
+        std::atomic<LoadState> state;
+        const char* file_path;
+        ModelCallback callback;
+        void* user_data;
+    };
+
+    // Lives in the loading task's frame while it waits on the I/O thread
+    struct ReadRequest {
+        tasks::TaskExecutor::ScheduledNode node;
+        const char* file_path;
+        // Handed to the decode, so the file is only mapped once
+        MappedFile file;
+        // file is the cooked copy rather than the OBJ
+        bool is_cooked;
+        // First byte of every page summed, keeps the reads from being optimized out
+        uint8_t page_sum;
+        ReadRequest* next;
+    };
+
+    // Lives in the loading task's frame while a worker parses the file
+    struct DecodeRequest {
+        tasks::TaskExecutor::ScheduledNode node;
+        tasks::TaskExecutor* task_executor;
+        jobs::JobSystem* job_system;
+        const char* file_path;
+        MappedFile* file;
+        bool is_cooked;
+        // Created and freed on workers, unmapping the pages the parser
+        // touched takes milliseconds. They grow with the model instead of
+        // reserving its worst case up front.
+        ObjectHolder<Arena> parse_arena;
+        ObjectHolder<Arena> model_arena;
+        ObjectHolder<vulkan::VulkanModel::VertexIndexInfo> vertex_index_info;
+        CookedMesh cooked_mesh;
+        vulkan::VulkanModel::MeshData mesh;
+    };
+
+    struct ReadAwaiter {
+        AssetLoader* loader;
+        ReadRequest* request;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            request->node.handle = handle;
+            loader->queue_read(request);
+        }
+
+        // False if the file couldn't be opened
+        bool await_resume() const noexcept {
+            return request->file.is_open();
+        }
+    };
+
+    // Runs function on a worker, which resumes the task once it's done.
+    // Unlike run_on_worker the loader's counter covers the resume as well.
+    struct JobAwaiter {
+        AssetLoader* loader;
+        DecodeRequest* request;
+        jobs::JobFunction function;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            request->node.handle = handle;
+            loader->m_job_system_->run(function, request, &loader->m_decode_counter_);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    tasks::TaskExecutor* m_task_executor_;
+    jobs::JobSystem* m_job_system_;
+    vulkan::DeviceWrapper* m_device_;
+    VkCommandPool m_command_pool_;
+    vulkan::VertexFormat m_vertex_format_;
+    ModelSlot* m_slots_;
+    uint32_t m_slot_capacity_;
+    uint32_t m_slot_count_;
+    vulkan::VulkanModel* m_placeholder_;
+    // Decodes still writing into task frames, the destructor waits for them
+    jobs::JobCounter m_decode_counter_;
+
+    std::mutex m_read_mutex_;
+    std::condition_variable m_read_condition_;
+    ReadRequest* m_read_head_;
+    ReadRequest* m_read_tail_;
+    bool m_is_stopping_;
+    std::thread m_io_thread_;
+
+    void io_loop();
+    void queue_read(ReadRequest* request);
+    static void decode(void* data);
+    static void release_decode_memory(void* data);
+    tasks::Task<void> load(ModelHandle handle);
+    void finish(ModelHandle handle, LoadState state);
+public:
+    // device is nullptr when headless, models then only keep their counts
+    AssetLoader(Arena& permanent_arena, tasks::TaskExecutor& task_executor, jobs::JobSystem& job_system, vulkan::DeviceWrapper* device, VkCommandPool command_pool,
+        vulkan::VertexFormat vertex_format, uint32_t max_models);
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+    AssetLoader(AssetLoader&&) = delete;
+    AssetLoader& operator=(AssetLoader&&) = delete;
+
+    // Queues a load and returns at once. file_path has to outlive the load.
+    // Only call it from the frame loop's thread.
+    ModelHandle request_model(const char* file_path, ModelCallback callback = nullptr, void* user_data = nullptr);
+    // Stands in for every model that isn't ready yet
+    void set_placeholder(vulkan::VulkanModel* placeholder);
+
+    // The model once it's ready, the placeholder before and if it failed.
+    // Safe from any thread.
+    [[nodiscard]] vulkan::VulkanModel* get_model(ModelHandle handle) const;
+    [[nodiscard]] LoadState get_state(ModelHandle handle) const;
+    // True once the load succeeded or failed
+    [[nodiscard]] bool is_done(ModelHandle handle) const;
+    // Resumes once the load is done, with nullptr if it failed
+    tasks::Task<vulkan::VulkanModel*> wait_for(ModelHandle handle);
+};
+
+}
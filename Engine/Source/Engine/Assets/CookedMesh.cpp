@@ -0,0 +1,236 @@
+#include "CookedMesh.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr char cooked_magic[4] = {'S', 'M', 'S', 'H'};
+constexpr const char* cooked_extension = ".smesh";
+constexpr size_t blob_alignment = 16;
+
+size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool get_source_stamp(const char* source_path, uint64_t& size, int64_t& write_time) {
+    std::error_code error;
+    size = std::filesystem::file_size(source_path, error);
+    if (error) {
+        return false;
+    }
+    write_time = std::filesystem::last_write_time(source_path, error).time_since_epoch().count();
+    return !error;
+}
+
+uint64_t mix(uint64_t hash, uint64_t word) {
+    constexpr uint64_t prime = 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ word) * prime;
+    return hash ^ (hash >> 29);
+}
+
+}
+
+uint64_t checksum(const uint8_t* data, size_t size) {
+    // Four independent lanes so the multiplies overlap
+    uint64_t lanes[4] = {size, size + 1, size + 2, size + 3};
+    size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            memcpy(&word, data + offset + lane * 8, sizeof(word));
+            lanes[lane] = mix(lanes[lane], word);
+        }
+    }
+    uint64_t hash = mix(mix(mix(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+    for (; offset < size; offset++) {
+        hash = mix(hash, data[offset]);
+    }
+    return hash;
+}
+
+CookedMesh::CookedMesh() : m_header_(nullptr) {
+}
+
+bool CookedMesh::open(const char* file_path, const char* source_path) {
+    MappedFile file;
+    if (!file.open(file_path)) {
+        close();
+        return false;
+    }
+    return open(std::move(file), source_path);
+}
+
+bool CookedMesh::open(MappedFile&& file, const char* source_path) {
+    close();
+    m_file_ = std::move(file);
+    if (m_file_.size() < sizeof(CookedMeshHeader)) {
+        close();
+        return false;
+    }
+    const auto* header = reinterpret_cast<const CookedMeshHeader*>(m_file_.data());
+    const size_t vertex_end = header->vertex_offset + static_cast<size_t>(header->vertex_count) * header->vertex_stride;
+    const size_t index_end = header->index_offset + static_cast<size_t>(header->index_count) * header->index_size;
+    const size_t lod_end = header->lod_offset + static_cast<size_t>(header->lod_count) * header->lod_stride;
+    const size_t meshlet_end = header->meshlet_offset + static_cast<size_t>(header->meshlet_count) * header->meshlet_stride;
+    const size_t meshlet_vertex_end = header->meshlet_vertex_offset + static_cast<size_t>(header->meshlet_vertex_count) * sizeof(uint32_t);
+    const size_t meshlet_triangle_end = header->meshlet_triangle_offset + header->meshlet_triangle_size;
+    const bool is_valid = memcmp(header->magic, cooked_magic, sizeof(cooked_magic)) == 0 &&
+        header->version == CookedMeshHeader::VERSION &&
+        header->vertex_stride == sizeof(vulkan::VulkanModel::Vertex) &&
+        (header->index_size == sizeof(uint16_t) || header->index_size == sizeof(uint32_t)) &&
+        header->lod_stride == sizeof(vulkan::VulkanModel::MeshLod) &&
+        header->lod_count > 0 && header->lod_count <= vulkan::VulkanModel::MAX_LODS &&
+        header->meshlet_stride == sizeof(assets::Meshlet) &&
+        header->vertex_offset % blob_alignment == 0 && header->index_offset % blob_alignment == 0 && header->lod_offset % blob_alignment == 0 &&
+        header->meshlet_offset % blob_alignment == 0 && header->meshlet_vertex_offset % blob_alignment == 0 && header->meshlet_triangle_offset % blob_alignment == 0 &&
+        vertex_end <= m_file_.size() && index_end <= m_file_.size() && lod_end <= m_file_.size() &&
+        meshlet_end <= m_file_.size() && meshlet_vertex_end <= m_file_.size() && meshlet_triangle_end <= m_file_.size();
+    if (!is_valid) {
+        close();
+        return false;
+    }
+    // Every range has to stay inside its blob, the draws and culling trust them
+    const auto* lods = reinterpret_cast<const vulkan::VulkanModel::MeshLod*>(m_file_.data() + header->lod_offset);
+    for (uint32_t i = 0; i < header->lod_count; i++) {
+        if (static_cast<uint64_t>(lods[i].index_offset) + lods[i].index_count > header->index_count ||
+            static_cast<uint64_t>(lods[i].meshlet_offset) + lods[i].meshlet_count > header->meshlet_count) {
+            close();
+            return false;
+        }
+    }
+    const auto* meshlets = reinterpret_cast<const Meshlet*>(m_file_.data() + header->meshlet_offset);
+    for (uint32_t i = 0; i < header->meshlet_count; i++) {
+        if (meshlets[i].vertex_count > MAX_MESHLET_VERTICES || meshlets[i].triangle_count > MAX_MESHLET_TRIANGLES ||
+            static_cast<uint64_t>(meshlets[i].vertex_offset) + meshlets[i].vertex_count > header->meshlet_vertex_count ||
+            static_cast<uint64_t>(meshlets[i].triangle_offset) + meshlets[i].triangle_count * 3 > header->meshlet_triangle_size) {
+            close();
+            return false;
+        }
+    }
+    if (source_path != nullptr) {
+        uint64_t source_size;
+        int64_t source_write_time;
+        if (!get_source_stamp(source_path, source_size, source_write_time) ||
+            source_size != header->source_size || source_write_time != header->source_write_time) {
+            close();
+            return false;
+        }
+    }
+    if (checksum(m_file_.data() + sizeof(CookedMeshHeader), m_file_.size() - sizeof(CookedMeshHeader)) != header->checksum) {
+        close();
+        return false;
+    }
+    m_header_ = header;
+    return true;
+}
+
+void CookedMesh::close() {
+    m_file_.close();
+    m_header_ = nullptr;
+}
+
+bool CookedMesh::is_open() const {
+    return m_header_ != nullptr;
+}
+
+const CookedMeshHeader& CookedMesh::get_header() const {
+    return *m_header_;
+}
+
+vulkan::VulkanModel::MeshData CookedMesh::get_mesh_data() const {
+    return {
+        .vertices = reinterpret_cast<const vulkan::VulkanModel::Vertex*>(m_file_.data() + m_header_->vertex_offset),
+        .vertex_count = m_header_->vertex_count,
+        .indices = m_file_.data() + m_header_->index_offset,
+        .index_count = m_header_->index_count,
+        .index_size = m_header_->index_size,
+        .lods = reinterpret_cast<const vulkan::VulkanModel::MeshLod*>(m_file_.data() + m_header_->lod_offset),
+        .lod_count = m_header_->lod_count,
+        .meshlets = reinterpret_cast<const Meshlet*>(m_file_.data() + m_header_->meshlet_offset),
+        .meshlet_count = m_header_->meshlet_count,
+        .meshlet_vertices = reinterpret_cast<const uint32_t*>(m_file_.data() + m_header_->meshlet_vertex_offset),
+        .meshlet_vertex_count = m_header_->meshlet_vertex_count,
+        .meshlet_triangles = m_file_.data() + m_header_->meshlet_triangle_offset,
+        .meshlet_triangle_size = m_header_->meshlet_triangle_size,
+    };
+}
+
+bool get_cooked_path(const char* source_path, char* cooked_path, size_t cooked_path_size) {
+    const int length = snprintf(cooked_path, cooked_path_size, "%s%s", source_path, cooked_extension);
+    return length > 0 && static_cast<size_t>(length) < cooked_path_size;
+}
+
+bool write_cooked_mesh(Arena& temp_arena, const char* file_path, const vulkan::VulkanModel::MeshData& mesh, const char* source_path) {
+    CookedMeshHeader header{};
+    memcpy(header.magic, cooked_magic, sizeof(cooked_magic));
+    header.version = CookedMeshHeader::VERSION;
+    header.vertex_stride = sizeof(vulkan::VulkanModel::Vertex);
+    header.index_size = vulkan::VulkanModel::get_index_size(mesh.vertex_count);
+    header.vertex_count = mesh.vertex_count;
+    header.index_count = mesh.index_count;
+    // Meshes without LODs get one covering all of their indices
+    const vulkan::VulkanModel::MeshLod whole_mesh{0, mesh.index_count, 0.f, 0, mesh.meshlet_count};
+    const vulkan::VulkanModel::MeshLod* lods = mesh.lod_count > 0 ? mesh.lods : &whole_mesh;
+    header.lod_count = std::max(mesh.lod_count, 1u);
+    header.lod_stride = sizeof(vulkan::VulkanModel::MeshLod);
+    header.meshlet_stride = sizeof(Meshlet);
+    header.meshlet_count = mesh.meshlet_count;
+    header.meshlet_vertex_count = mesh.meshlet_vertex_count;
+    header.meshlet_triangle_size = mesh.meshlet_triangle_size;
+    if (!get_source_stamp(source_path, header.source_size, header.source_write_time)) {
+        return false;
+    }
+
+    const size_t vertex_size = static_cast<size_t>(mesh.vertex_count) * sizeof(vulkan::VulkanModel::Vertex);
+    const size_t index_size = static_cast<size_t>(mesh.index_count) * header.index_size;
+    const size_t lod_size = static_cast<size_t>(header.lod_count) * sizeof(vulkan::VulkanModel::MeshLod);
+    header.lod_offset = align_up(sizeof(CookedMeshHeader), blob_alignment);
+    header.vertex_offset = align_up(header.lod_offset + lod_size, blob_alignment);
+    header.index_offset = align_up(header.vertex_offset + vertex_size, blob_alignment);
+    const size_t meshlet_size = static_cast<size_t>(mesh.meshlet_count) * sizeof(Meshlet);
+    const size_t meshlet_vertex_size = static_cast<size_t>(mesh.meshlet_vertex_count) * sizeof(uint32_t);
+    header.meshlet_offset = align_up(header.index_offset + index_size, blob_alignment);
+    header.meshlet_vertex_offset = align_up(header.meshlet_offset + meshlet_size, blob_alignment);
+    header.meshlet_triangle_offset = align_up(header.meshlet_vertex_offset + meshlet_vertex_size, blob_alignment);
+    const size_t file_size = header.meshlet_triangle_offset + mesh.meshlet_triangle_size;
+
+    for (size_t axis = 0; axis < 3; axis++) {
+        header.bounds_min[axis] = mesh.vertex_count > 0 ? mesh.vertices[0].position[axis] : 0.f;
+        header.bounds_max[axis] = header.bounds_min[axis];
+    }
+    for (uint32_t i = 0; i < mesh.vertex_count; i++) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            header.bounds_min[axis] = std::min(header.bounds_min[axis], mesh.vertices[i].position[axis]);
+            header.bounds_max[axis] = std::max(header.bounds_max[axis], mesh.vertices[i].position[axis]);
+        }
+    }
+
+    auto* image = static_cast<uint8_t*>(temp_arena.push_zero(file_size, blob_alignment));
+    memcpy(image + header.lod_offset, lods, lod_size);
+    memcpy(image + header.vertex_offset, mesh.vertices, vertex_size);
+    if (mesh.meshlet_count > 0) {
+        memcpy(image + header.meshlet_offset, mesh.meshlets, meshlet_size);
+        memcpy(image + header.meshlet_vertex_offset, mesh.meshlet_vertices, meshlet_vertex_size);
+        memcpy(image + header.meshlet_triangle_offset, mesh.meshlet_triangles, mesh.meshlet_triangle_size);
+    }
+    if (index_size > 0) {
+        vulkan::VulkanModel::encode_indices(mesh, header.index_size, image + header.index_offset);
+    }
+    header.checksum = checksum(image + sizeof(CookedMeshHeader), file_size - sizeof(CookedMeshHeader));
+    memcpy(image, &header, sizeof(header));
+
+    FILE* file = fopen(file_path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool is_written = fwrite(image, 1, file_size, file) == file_size;
+    return fclose(file) == 0 && is_written;
+}
+
+}
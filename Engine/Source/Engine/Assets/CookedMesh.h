@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MappedFile.h"
+#include "Engine/Vulkan/VulkanModel.h"
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+// File layout is the header, then the LOD table, the vertex and index blobs
+// and the meshlet blobs at their offsets, each 16 byte aligned so the mapping
+// can be used in place.
+struct CookedMeshHeader {
+    static constexpr uint32_t VERSION = 5;
+
+    char magic[4];
+    uint32_t version;
+    // sizeof(Vertex) when cooked, a layout change makes the file stale
+    uint32_t vertex_stride;
+    // 2 when the vertex count allows 16 bit indices, 4 otherwise
+    uint32_t index_size;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    // At least one, LOD 0 is the full mesh
+    uint32_t lod_count;
+    // sizeof(MeshLod) when cooked
+    uint32_t lod_stride;
+    // sizeof(Meshlet) when cooked
+    uint32_t meshlet_stride;
+    uint32_t meshlet_count;
+    uint32_t meshlet_vertex_count;
+    // In bytes, three per triangle plus the padding between meshlets
+    uint32_t meshlet_triangle_size;
+    uint64_t lod_offset;
+    uint64_t vertex_offset;
+    uint64_t index_offset;
+    uint64_t meshlet_offset;
+    uint64_t meshlet_vertex_offset;
+    uint64_t meshlet_triangle_offset;
+    float bounds_min[3];
+    float bounds_max[3];
+    // Size and write time of the source it was cooked from
+    uint64_t source_size;
+    int64_t source_write_time;
+    // Over everything after the header
+    uint64_t checksum;
+};
+
+// A cooked mesh mapped from disk. The mesh data points into the mapping, so
+// the mesh has to stay open until the upload copied it.
+class CookedMesh {
+    MappedFile m_file_;
+    const CookedMeshHeader* m_header_;
+public:
+    CookedMesh();
+    CookedMesh(const CookedMesh&) = delete;
+    CookedMesh(CookedMesh&&) = delete;
+    CookedMesh& operator=(const CookedMesh&) = delete;
+    CookedMesh& operator=(CookedMesh&&) = delete;
+    ~CookedMesh() = default;
+
+    // False if the file is missing, corrupt, from another format version or,
+    // given a source_path, cooked from a different version of the source
+    bool open(const char* file_path, const char* source_path = nullptr);
+    // Same checks on a file that's already mapped, the mesh takes the mapping
+    // over. file is left closed either way.
+    bool open(MappedFile&& file, const char* source_path = nullptr);
+    void close();
+
+    [[nodiscard]] bool is_open() const;
+    [[nodiscard]] const CookedMeshHeader& get_header() const;
+    [[nodiscard]] vulkan::VulkanModel::MeshData get_mesh_data() const;
+};
+
+// source_path with the cooked extension appended, false if it doesn't fit
+bool get_cooked_path(const char* source_path, char* cooked_path, size_t cooked_path_size);
+// Builds the file image in temp_arena and writes it in one go
+bool write_cooked_mesh(Arena& temp_arena, const char* file_path, const vulkan::VulkanModel::MeshData& mesh, const char* source_path);
+uint64_t checksum(const uint8_t* data, size_t size);
+
+}
@@ -0,0 +1,134 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine::assets {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : m_data_(nullptr), m_size_(0), m_file_handle_(INVALID_HANDLE_VALUE), m_mapping_handle_(nullptr) {
+}
+
+bool MappedFile::open(const char* file_path) {
+    close();
+    m_file_handle_ = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file_handle_ == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(m_file_handle_, &file_size) || file_size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    m_mapping_handle_ = CreateFileMappingA(m_file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping_handle_ == nullptr) {
+        close();
+        return false;
+    }
+    m_data_ = static_cast<const uint8_t*>(MapViewOfFile(m_mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+    if (m_data_ == nullptr) {
+        close();
+        return false;
+    }
+    m_size_ = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data_ != nullptr) {
+        UnmapViewOfFile(m_data_);
+    }
+    if (m_mapping_handle_ != nullptr) {
+        CloseHandle(m_mapping_handle_);
+    }
+    if (m_file_handle_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file_handle_);
+    }
+    m_data_ = nullptr;
+    m_size_ = 0;
+    m_file_handle_ = INVALID_HANDLE_VALUE;
+    m_mapping_handle_ = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : m_data_(nullptr), m_size_(0) {
+}
+
+bool MappedFile::open(const char* file_path) {
+    close();
+    const int file = ::open(file_path, O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat file_stat{};
+    if (fstat(file, &file_stat) != 0 || file_stat.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    // The mapping keeps the file alive on its own
+    ::close(file);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    m_data_ = static_cast<const uint8_t*>(data);
+    m_size_ = static_cast<size_t>(file_stat.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(m_data_), m_size_);
+    }
+    m_data_ = nullptr;
+    m_size_ = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data_ = std::exchange(other.m_data_, nullptr);
+        m_size_ = std::exchange(other.m_size_, 0);
+#ifdef _WIN32
+        m_file_handle_ = std::exchange(other.m_file_handle_, INVALID_HANDLE_VALUE);
+        m_mapping_handle_ = std::exchange(other.m_mapping_handle_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::is_open() const {
+    return m_data_ != nullptr;
+}
+
+const uint8_t* MappedFile::data() const {
+    return m_data_;
+}
+
+size_t MappedFile::size() const {
+    return m_size_;
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine::assets {
+
+// Read only memory mapping of a whole file. Pages are faulted in on first
+// touch, so nothing is read until the data is used.
+class MappedFile {
+    const uint8_t* m_data_;
+    size_t m_size_;
+#ifdef _WIN32
+    void* m_file_handle_;
+    void* m_mapping_handle_;
+#endif
+public:
+    MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    // Hands the mapping over, other is left closed
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile();
+
+    // False if the file is missing, empty or can't be mapped
+    bool open(const char* file_path);
+    void close();
+
+    [[nodiscard]] bool is_open() const;
+    [[nodiscard]] const uint8_t* data() const;
+    [[nodiscard]] size_t size() const;
+};
+
+}
@@ -0,0 +1,274 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr float cache_decay_power = 1.5f;
+constexpr float last_triangle_score = 0.75f;
+constexpr float valence_boost_scale = 2.f;
+constexpr float valence_boost_power = 0.5f;
+// Small enough that a cluster seam means the hardware cache really is cold
+constexpr uint32_t overdraw_cache_size = 16;
+
+float get_vertex_score(int32_t cache_position, uint32_t remaining_triangles) {
+    if (remaining_triangles == 0) {
+        return -1.f;
+    }
+    float score = 0.f;
+    if (cache_position >= 0) {
+        // The last triangle's vertices get a fixed score so the next one
+        // doesn't simply reuse its edge
+        if (cache_position < 3) {
+            score = last_triangle_score;
+        } else {
+            const float scale = 1.f / static_cast<float>(VERTEX_CACHE_SIZE - 3);
+            score = std::pow(1.f - static_cast<float>(cache_position - 3) * scale, cache_decay_power);
+        }
+    }
+    return score + valence_boost_scale * std::pow(static_cast<float>(remaining_triangles), -valence_boost_power);
+}
+
+// Counts a miss whenever a vertex isn't among the last cache_size that missed
+struct FifoCache {
+    uint32_t* miss_times;
+    uint32_t cache_size;
+    uint32_t time;
+
+    FifoCache(Arena& arena, size_t vertex_count, uint32_t cache_size) : miss_times(arena.push_array<uint32_t>(vertex_count)), cache_size(cache_size), time(cache_size + 1) {
+        memset(miss_times, 0, std::max<size_t>(vertex_count, 1) * sizeof(uint32_t));
+    }
+
+    bool access(uint32_t vertex) {
+        if (time - miss_times[vertex] > cache_size) {
+            miss_times[vertex] = time++;
+            return false;
+        }
+        return true;
+    }
+};
+
+}
+
+void optimize_vertex_cache(Arena& temp_arena, uint32_t* indices, size_t index_count, size_t vertex_count) {
+    assert(index_count % 3 == 0 && "Indices have to be a triangle list");
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    // Triangles using each vertex, packed. Emitted triangles are swapped past
+    // the vertex's remaining count.
+    uint32_t* remaining = temp_arena.push_array<uint32_t>(vertex_count);
+    uint32_t* offsets = temp_arena.push_array<uint32_t>(vertex_count + 1);
+    uint32_t* vertex_triangles = temp_arena.push_array<uint32_t>(index_count);
+    memset(remaining, 0, vertex_count * sizeof(uint32_t));
+    for (size_t i = 0; i < index_count; i++) {
+        remaining[indices[i]]++;
+    }
+    offsets[0] = 0;
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+        remaining[vertex] = 0;
+    }
+    for (size_t i = 0; i < index_count; i++) {
+        const uint32_t vertex = indices[i];
+        vertex_triangles[offsets[vertex] + remaining[vertex]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    int32_t* cache_positions = temp_arena.push_array<int32_t>(vertex_count);
+    float* vertex_scores = temp_arena.push_array<float>(vertex_count);
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        cache_positions[vertex] = -1;
+        vertex_scores[vertex] = get_vertex_score(-1, remaining[vertex]);
+    }
+    float* triangle_scores = temp_arena.push_array<float>(triangle_count);
+    bool* is_emitted = temp_arena.push_array<bool>(triangle_count);
+    memset(is_emitted, 0, triangle_count * sizeof(bool));
+    size_t best_triangle = 0;
+    for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+        triangle_scores[triangle] = vertex_scores[indices[triangle * 3]] + vertex_scores[indices[triangle * 3 + 1]] + vertex_scores[indices[triangle * 3 + 2]];
+        if (triangle_scores[triangle] > triangle_scores[best_triangle]) {
+            best_triangle = triangle;
+        }
+    }
+
+    uint32_t* output = temp_arena.push_array<uint32_t>(index_count);
+    uint32_t cache[VERTEX_CACHE_SIZE + 3];
+    uint32_t cache_count = 0;
+    size_t input_cursor = 0;
+    for (size_t emitted = 0; emitted < triangle_count; emitted++) {
+        // Nothing in the cache has triangles left, continue in input order
+        if (best_triangle == SIZE_MAX) {
+            while (is_emitted[input_cursor]) {
+                input_cursor++;
+            }
+            best_triangle = input_cursor;
+        }
+        is_emitted[best_triangle] = true;
+        const uint32_t* triangle = indices + best_triangle * 3;
+        memcpy(output + emitted * 3, triangle, 3 * sizeof(uint32_t));
+
+        for (size_t corner = 0; corner < 3; corner++) {
+            const uint32_t vertex = triangle[corner];
+            uint32_t* begin = vertex_triangles + offsets[vertex];
+            uint32_t* end = begin + remaining[vertex];
+            uint32_t* found = std::find(begin, end, static_cast<uint32_t>(best_triangle));
+            assert(found != end && "Emitted triangle missing from its vertex");
+            std::swap(*found, *(end - 1));
+            remaining[vertex]--;
+        }
+
+        // The triangle's vertices move to the front and push the rest back
+        uint32_t new_cache[VERTEX_CACHE_SIZE + 3];
+        uint32_t new_cache_count = 0;
+        for (size_t corner = 0; corner < 3; corner++) {
+            new_cache[new_cache_count++] = triangle[corner];
+        }
+        for (uint32_t i = 0; i < cache_count; i++) {
+            const uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                new_cache[new_cache_count++] = vertex;
+            }
+        }
+
+        best_triangle = SIZE_MAX;
+        float best_score = -1.f;
+        for (uint32_t i = 0; i < new_cache_count; i++) {
+            const uint32_t vertex = new_cache[i];
+            const int32_t cache_position = i < VERTEX_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+            cache_positions[vertex] = cache_position;
+            const float score = get_vertex_score(cache_position, remaining[vertex]);
+            const float delta = score - vertex_scores[vertex];
+            vertex_scores[vertex] = score;
+            for (uint32_t j = 0; j < remaining[vertex]; j++) {
+                const uint32_t candidate = vertex_triangles[offsets[vertex] + j];
+                triangle_scores[candidate] += delta;
+                if (triangle_scores[candidate] > best_score) {
+                    best_score = triangle_scores[candidate];
+                    best_triangle = candidate;
+                }
+            }
+        }
+        cache_count = std::min(new_cache_count, VERTEX_CACHE_SIZE);
+        memcpy(cache, new_cache, cache_count * sizeof(uint32_t));
+    }
+    memcpy(indices, output, index_count * sizeof(uint32_t));
+}
+
+void optimize_overdraw(Arena& temp_arena, uint32_t* indices, size_t index_count, const float* positions, size_t position_stride, size_t vertex_count) {
+    assert(index_count % 3 == 0 && "Indices have to be a triangle list");
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+    const auto get_position = [&](uint32_t vertex) {
+        const float* position = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + vertex * position_stride);
+        return glm::vec3{position[0], position[1], position[2]};
+    };
+
+    // A cluster starts at every triangle whose vertices all miss
+    uint32_t* cluster_starts = temp_arena.push_array<uint32_t>(triangle_count + 1);
+    size_t cluster_count = 0;
+    FifoCache cache{temp_arena, vertex_count, overdraw_cache_size};
+    for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+        const bool hit_a = cache.access(indices[triangle * 3]);
+        const bool hit_b = cache.access(indices[triangle * 3 + 1]);
+        const bool hit_c = cache.access(indices[triangle * 3 + 2]);
+        if (triangle == 0 || (!hit_a && !hit_b && !hit_c)) {
+            cluster_starts[cluster_count++] = static_cast<uint32_t>(triangle);
+        }
+    }
+    cluster_starts[cluster_count] = static_cast<uint32_t>(triangle_count);
+
+    glm::vec3 mesh_centroid{0.f, 0.f, 0.f};
+    float mesh_area = 0.f;
+    glm::vec3* cluster_centroids = temp_arena.push_array<glm::vec3>(cluster_count);
+    glm::vec3* cluster_normals = temp_arena.push_array<glm::vec3>(cluster_count);
+    for (size_t cluster = 0; cluster < cluster_count; cluster++) {
+        glm::vec3 centroid{0.f, 0.f, 0.f};
+        glm::vec3 normal{0.f, 0.f, 0.f};
+        float area = 0.f;
+        for (size_t triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1]; triangle++) {
+            const glm::vec3 a = get_position(indices[triangle * 3]);
+            const glm::vec3 b = get_position(indices[triangle * 3 + 1]);
+            const glm::vec3 c = get_position(indices[triangle * 3 + 2]);
+            // Twice the area, weighting by it keeps slivers from steering the normal
+            const glm::vec3 triangle_normal = glm::cross(b - a, c - a);
+            const float triangle_area = glm::length(triangle_normal);
+            centroid += (a + b + c) * (triangle_area / 3.f);
+            normal += triangle_normal;
+            area += triangle_area;
+        }
+        mesh_centroid += centroid;
+        mesh_area += area;
+        cluster_centroids[cluster] = area > 0.f ? centroid / area : get_position(indices[cluster_starts[cluster] * 3]);
+        cluster_normals[cluster] = normal;
+    }
+    if (mesh_area > 0.f) {
+        mesh_centroid = mesh_centroid / mesh_area;
+    }
+
+    // Clusters facing away from the middle are the most likely to be in front
+    float* sort_keys = temp_arena.push_array<float>(cluster_count);
+    uint32_t* cluster_order = temp_arena.push_array<uint32_t>(cluster_count);
+    for (size_t cluster = 0; cluster < cluster_count; cluster++) {
+        const float normal_length = glm::length(cluster_normals[cluster]);
+        sort_keys[cluster] = normal_length > 0.f ? glm::dot(cluster_centroids[cluster] - mesh_centroid, cluster_normals[cluster]) / normal_length : 0.f;
+        cluster_order[cluster] = static_cast<uint32_t>(cluster);
+    }
+    std::stable_sort(cluster_order, cluster_order + cluster_count, [&](uint32_t a, uint32_t b) {
+        return sort_keys[a] > sort_keys[b];
+    });
+
+    uint32_t* output = temp_arena.push_array<uint32_t>(index_count);
+    size_t written = 0;
+    for (size_t i = 0; i < cluster_count; i++) {
+        const uint32_t cluster = cluster_order[i];
+        const size_t begin = cluster_starts[cluster] * 3;
+        const size_t end = cluster_starts[cluster + 1] * 3;
+        memcpy(output + written, indices + begin, (end - begin) * sizeof(uint32_t));
+        written += end - begin;
+    }
+    memcpy(indices, output, index_count * sizeof(uint32_t));
+}
+
+size_t optimize_vertex_fetch(Arena& temp_arena, uint32_t* indices, size_t index_count, void* vertices, size_t vertex_count, size_t stride) {
+    constexpr uint32_t unused = UINT32_MAX;
+    uint32_t* remap = temp_arena.push_array<uint32_t>(vertex_count);
+    memset(remap, 0xff, vertex_count * sizeof(uint32_t));
+    auto* vertex_bytes = static_cast<uint8_t*>(vertices);
+    auto* reordered = temp_arena.push_array<uint8_t>(vertex_count * stride);
+    uint32_t next_vertex = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        uint32_t& mapped = remap[indices[i]];
+        if (mapped == unused) {
+            memcpy(reordered + next_vertex * stride, vertex_bytes + indices[i] * stride, stride);
+            mapped = next_vertex++;
+        }
+        indices[i] = mapped;
+    }
+    memcpy(vertex_bytes, reordered, next_vertex * stride);
+    return next_vertex;
+}
+
+float get_acmr(Arena& temp_arena, const uint32_t* indices, size_t index_count, size_t vertex_count, uint32_t cache_size) {
+    if (index_count < 3) {
+        return 0.f;
+    }
+    FifoCache cache{temp_arena, vertex_count, cache_size};
+    size_t misses = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        misses += cache.access(indices[i]) ? 0 : 1;
+    }
+    return static_cast<float>(misses) / static_cast<float>(index_count / 3);
+}
+
+}
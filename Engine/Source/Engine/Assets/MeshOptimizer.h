@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+// Post transform cache the optimizer and get_acmr model
+constexpr uint32_t VERTEX_CACHE_SIZE = 32;
+
+// Reorders triangles so recently used vertices are reused while they are
+// still in the post transform cache. Forsyth's linear speed algorithm.
+void optimize_vertex_cache(Arena& temp_arena, uint32_t* indices, size_t index_count, size_t vertex_count);
+// Splits the cache ordered triangles where the cache would start over anyway
+// and draws the outward facing clusters first, so fewer hidden pixels get
+// shaded. Costs a little cache efficiency at the cluster seams.
+void optimize_overdraw(Arena& temp_arena, uint32_t* indices, size_t index_count, const float* positions, size_t position_stride, size_t vertex_count);
+// Moves vertices into the order the indices first use them and remaps the
+// indices to match. Returns how many vertices are left, unused ones are
+// dropped off the end.
+size_t optimize_vertex_fetch(Arena& temp_arena, uint32_t* indices, size_t index_count, void* vertices, size_t vertex_count, size_t stride);
+
+// Average cache misses per triangle with a FIFO cache of cache_size, 0.5 is
+// the best a large grid can do and 3 means every vertex misses.
+float get_acmr(Arena& temp_arena, const uint32_t* indices, size_t index_count, size_t vertex_count, uint32_t cache_size);
+
+}
@@ -0,0 +1,303 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include "VertexWeld.h"
+
+namespace engine::assets {
+
+namespace {
+
+// A pass takes collapses up to this much above the error of the one that
+// would reach its goal, so it stays close to the order a priority queue gives
+constexpr float pass_error_slack = 1.5f;
+
+// Sum of squared distances to a set of planes, weighted by triangle area
+struct Quadric {
+    float a00, a11, a22, a01, a02, a12;
+    float b0, b1, b2;
+    float c;
+    float weight;
+
+    static Quadric from_plane(const glm::vec3& normal, float distance, float weight) {
+        return {
+            weight * normal.x * normal.x, weight * normal.y * normal.y, weight * normal.z * normal.z,
+            weight * normal.x * normal.y, weight * normal.x * normal.z, weight * normal.y * normal.z,
+            weight * normal.x * distance, weight * normal.y * distance, weight * normal.z * distance,
+            weight * distance * distance,
+            weight,
+        };
+    }
+
+    void add(const Quadric& other) {
+        a00 += other.a00;
+        a11 += other.a11;
+        a22 += other.a22;
+        a01 += other.a01;
+        a02 += other.a02;
+        a12 += other.a12;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    // Mean squared distance of point to the planes
+    [[nodiscard]] float evaluate(const glm::vec3& point) const {
+        const float x = point.x;
+        const float y = point.y;
+        const float z = point.z;
+        const float error = a00 * x * x + a11 * y * y + a22 * z * z +
+            2.f * (a01 * x * y + a02 * x * z + a12 * y * z) +
+            2.f * (b0 * x + b1 * y + b2 * z) + c;
+        return weight > 0.f ? std::max(error, 0.f) / weight : 0.f;
+    }
+};
+
+struct Collapse {
+    uint32_t from;
+    uint32_t to;
+    float error;
+};
+
+// Triangles around each point, packed
+struct Adjacency {
+    uint32_t* offsets;
+    uint32_t* triangles;
+
+    void build(const uint32_t* points, size_t triangle_count, size_t point_count) {
+        memset(offsets, 0, (point_count + 1) * sizeof(uint32_t));
+        for (size_t i = 0; i < triangle_count * 3; i++) {
+            offsets[points[i] + 1]++;
+        }
+        for (size_t point = 0; point < point_count; point++) {
+            offsets[point + 1] += offsets[point];
+        }
+        for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+            for (size_t corner = 0; corner < 3; corner++) {
+                triangles[offsets[points[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+            }
+        }
+        // Filling advanced every offset to the next point's start
+        for (size_t point = point_count; point > 0; point--) {
+            offsets[point] = offsets[point - 1];
+        }
+        offsets[0] = 0;
+    }
+};
+
+}
+
+size_t simplify(Arena& temp_arena, const uint32_t* indices, size_t index_count, const float* positions, const float* normals, size_t vertex_stride, size_t vertex_count,
+    size_t target_index_count, float target_error, uint32_t* destination, float* result_error) {
+    assert(index_count % 3 == 0 && "Indices have to be a triangle list");
+    const auto get_vector = [&](const float* base, uint32_t vertex) {
+        const float* vector = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(base) + vertex * vertex_stride);
+        return glm::vec3{vector[0], vector[1], vector[2]};
+    };
+    *result_error = 0.f;
+
+    // Collapses work on points, vertices welded by position alone, so
+    // attribute seams don't tear the surface open
+    uint32_t* vertex_points = temp_arena.push_array<uint32_t>(vertex_count);
+    const size_t point_count = weld_vertices(temp_arena, positions, vertex_count, vertex_stride, 3 * sizeof(float), 0.f, vertex_points);
+    glm::vec3* point_positions = temp_arena.push_array<glm::vec3>(point_count);
+    uint32_t* first_vertices = temp_arena.push_array<uint32_t>(point_count);
+    uint32_t* next_vertices = temp_arena.push_array<uint32_t>(vertex_count);
+    // Vertices at each point as a linked list
+    std::fill_n(first_vertices, point_count, UINT32_MAX);
+    for (size_t vertex = vertex_count; vertex > 0; vertex--) {
+        const uint32_t point = vertex_points[vertex - 1];
+        point_positions[point] = get_vector(positions, static_cast<uint32_t>(vertex - 1));
+        next_vertices[vertex - 1] = first_vertices[point];
+        first_vertices[point] = static_cast<uint32_t>(vertex - 1);
+    }
+
+    // Triangles as points, with the vertex each corner started out as
+    uint32_t* points = temp_arena.push_array<uint32_t>(index_count);
+    uint32_t* corner_vertices = temp_arena.push_array<uint32_t>(index_count);
+    size_t triangle_count = 0;
+    for (size_t i = 0; i < index_count; i += 3) {
+        const uint32_t a = vertex_points[indices[i]];
+        const uint32_t b = vertex_points[indices[i + 1]];
+        const uint32_t c = vertex_points[indices[i + 2]];
+        if (a == b || b == c || a == c) {
+            continue;
+        }
+        points[triangle_count * 3] = a;
+        points[triangle_count * 3 + 1] = b;
+        points[triangle_count * 3 + 2] = c;
+        memcpy(corner_vertices + triangle_count * 3, indices + i, 3 * sizeof(uint32_t));
+        triangle_count++;
+    }
+
+    Quadric* quadrics = temp_arena.push_array<Quadric>(point_count);
+    memset(quadrics, 0, point_count * sizeof(Quadric));
+    for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+        const glm::vec3 a = point_positions[points[triangle * 3]];
+        const glm::vec3 normal = glm::cross(point_positions[points[triangle * 3 + 1]] - a, point_positions[points[triangle * 3 + 2]] - a);
+        const float double_area = glm::length(normal);
+        if (double_area == 0.f) {
+            continue;
+        }
+        const glm::vec3 unit_normal = normal / double_area;
+        const Quadric quadric = Quadric::from_plane(unit_normal, -glm::dot(unit_normal, a), double_area * 0.5f);
+        for (size_t corner = 0; corner < 3; corner++) {
+            quadrics[points[triangle * 3 + corner]].add(quadric);
+        }
+    }
+
+    Adjacency adjacency{temp_arena.push_array<uint32_t>(point_count + 1), temp_arena.push_array<uint32_t>(triangle_count * 3)};
+    adjacency.build(points, triangle_count, point_count);
+
+    // A point is on a border when one of its edges has no twin running the
+    // other way. Those never move, so open meshes keep their outline.
+    uint8_t* locked = temp_arena.push_array<uint8_t>(point_count);
+    memset(locked, 0, point_count);
+    for (uint32_t point = 0; point < point_count; point++) {
+        for (uint32_t i = adjacency.offsets[point]; i < adjacency.offsets[point + 1] && locked[point] == 0; i++) {
+            const uint32_t* triangle = points + adjacency.triangles[i] * 3;
+            const uint32_t corner = triangle[0] == point ? 0 : triangle[1] == point ? 1 : 2;
+            const uint32_t next = triangle[(corner + 1) % 3];
+            bool has_twin = false;
+            for (uint32_t j = adjacency.offsets[point]; j < adjacency.offsets[point + 1] && !has_twin; j++) {
+                const uint32_t* other = points + adjacency.triangles[j] * 3;
+                const uint32_t other_corner = other[0] == point ? 0 : other[1] == point ? 1 : 2;
+                has_twin = other[(other_corner + 2) % 3] == next;
+            }
+            locked[point] = has_twin ? 0 : 1;
+        }
+    }
+
+    uint32_t* collapse_targets = temp_arena.push_array<uint32_t>(point_count);
+    uint8_t* touched = temp_arena.push_array<uint8_t>(point_count);
+    Collapse* collapses = temp_arena.push_array<Collapse>(triangle_count * 3);
+    for (uint32_t point = 0; point < point_count; point++) {
+        collapse_targets[point] = point;
+    }
+
+    // Collapsing from into to flips a triangle when its normal turns around
+    const auto is_flipping = [&](uint32_t from, uint32_t to) {
+        for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++) {
+            const uint32_t* triangle = points + adjacency.triangles[i] * 3;
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                continue;
+            }
+            glm::vec3 corners[3];
+            for (size_t corner = 0; corner < 3; corner++) {
+                corners[corner] = point_positions[triangle[corner]];
+            }
+            const glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            for (size_t corner = 0; corner < 3; corner++) {
+                if (triangle[corner] == from) {
+                    corners[corner] = point_positions[to];
+                }
+            }
+            const glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+            if (glm::dot(before, after) <= 0.f) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const size_t target_triangle_count = target_index_count / 3;
+    const float error_limit = target_error * target_error;
+    float max_error = 0.f;
+    while (triangle_count > target_triangle_count) {
+        // Interior edges show up once per direction, the lower to higher one
+        // stands for both
+        size_t collapse_count = 0;
+        for (size_t i = 0; i < triangle_count * 3; i++) {
+            const uint32_t a = points[i];
+            const uint32_t b = points[i - i % 3 + (i + 1) % 3];
+            if (a > b || (locked[a] != 0 && locked[b] != 0)) {
+                continue;
+            }
+            Quadric quadric = quadrics[a];
+            quadric.add(quadrics[b]);
+            const float error_to_b = locked[a] != 0 ? INFINITY : quadric.evaluate(point_positions[b]);
+            const float error_to_a = locked[b] != 0 ? INFINITY : quadric.evaluate(point_positions[a]);
+            collapses[collapse_count++] = error_to_b <= error_to_a ? Collapse{a, b, error_to_b} : Collapse{b, a, error_to_a};
+        }
+        if (collapse_count == 0) {
+            break;
+        }
+        std::sort(collapses, collapses + collapse_count, [](const Collapse& a, const Collapse& b) {
+            return a.error < b.error;
+        });
+
+        // An interior collapse removes two triangles
+        const size_t goal = triangle_count - target_triangle_count;
+        const float pass_limit = collapses[std::min(collapse_count - 1, goal / 2)].error * pass_error_slack;
+        memset(touched, 0, point_count);
+        size_t removed_count = 0;
+        for (size_t i = 0; i < collapse_count && removed_count < goal; i++) {
+            const Collapse& collapse = collapses[i];
+            if (collapse.error > error_limit || collapse.error > pass_limit) {
+                break;
+            }
+            if (touched[collapse.from] != 0 || touched[collapse.to] != 0 || is_flipping(collapse.from, collapse.to)) {
+                continue;
+            }
+            // Every point sharing a triangle with from sees its triangles
+            // change, none of them may collapse again this pass
+            for (uint32_t j = adjacency.offsets[collapse.from]; j < adjacency.offsets[collapse.from + 1]; j++) {
+                const uint32_t* triangle = points + adjacency.triangles[j] * 3;
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+                    removed_count++;
+                }
+            }
+            collapse_targets[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            max_error = std::max(max_error, collapse.error);
+        }
+        if (removed_count == 0) {
+            break;
+        }
+
+        size_t kept_count = 0;
+        for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+            const uint32_t a = collapse_targets[points[triangle * 3]];
+            const uint32_t b = collapse_targets[points[triangle * 3 + 1]];
+            const uint32_t c = collapse_targets[points[triangle * 3 + 2]];
+            if (a == b || b == c || a == c) {
+                continue;
+            }
+            points[kept_count * 3] = a;
+            points[kept_count * 3 + 1] = b;
+            points[kept_count * 3 + 2] = c;
+            memmove(corner_vertices + kept_count * 3, corner_vertices + triangle * 3, 3 * sizeof(uint32_t));
+            kept_count++;
+        }
+        triangle_count = kept_count;
+        adjacency.build(points, triangle_count, point_count);
+    }
+
+    for (size_t i = 0; i < triangle_count * 3; i++) {
+        uint32_t vertex = corner_vertices[i];
+        if (vertex_points[vertex] != points[i]) {
+            const glm::vec3 normal = normals != nullptr ? get_vector(normals, vertex) : glm::vec3{0.f};
+            float best_match = -INFINITY;
+            for (uint32_t candidate = first_vertices[points[i]]; candidate != UINT32_MAX; candidate = next_vertices[candidate]) {
+                const float match = normals != nullptr ? glm::dot(normal, get_vector(normals, candidate)) : 0.f;
+                if (match > best_match) {
+                    best_match = match;
+                    vertex = candidate;
+                }
+            }
+        }
+        destination[i] = vertex;
+    }
+    *result_error = std::sqrt(max_error);
+    return triangle_count * 3;
+}
+
+}
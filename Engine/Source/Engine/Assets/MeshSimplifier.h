@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+// Collapses edges in order of quadric error until the triangles are down to
+// target_index_count or the next collapse would move the surface further than
+// target_error, in model units. Vertices only ever merge into other
+// vertices, so the result indexes the same vertex buffer. Vertices sharing a
+// position are simplified together, each corner then takes the vertex at its
+// new position whose normal is closest to its old one. Border vertices never
+// move. destination needs room for index_count indices, returns how many it
+// wrote and the error reached in result_error.
+size_t simplify(Arena& temp_arena, const uint32_t* indices, size_t index_count, const float* positions, const float* normals, size_t vertex_stride, size_t vertex_count,
+    size_t target_index_count, float target_error, uint32_t* destination, float* result_error);
+
+}
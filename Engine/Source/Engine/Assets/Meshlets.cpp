@@ -0,0 +1,222 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr uint8_t no_local_index = UINT8_MAX;
+// Triangles bending further than this from the average normal leave a cone
+// too wide to ever cull
+constexpr float min_cone_dot = 0.1f;
+
+glm::vec3 get_position(const float* positions, size_t position_stride, uint32_t vertex) {
+    const float* position = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + vertex * position_stride);
+    return {position[0], position[1], position[2]};
+}
+
+}
+
+uint32_t build_meshlets(Arena& temp_arena, const uint32_t* indices, size_t index_count, const float* positions, size_t position_stride, size_t vertex_count,
+    DynArray<Meshlet>& meshlets, DynArray<uint32_t>& meshlet_vertices, DynArray<uint8_t>& meshlet_triangles) {
+    assert(index_count % 3 == 0 && "Indices have to be a triangle list");
+    const size_t triangle_count = index_count / 3;
+    if (triangle_count == 0) {
+        return 0;
+    }
+
+    // Triangles using each vertex, packed
+    uint32_t* offsets = temp_arena.push_array<uint32_t>(vertex_count + 1);
+    uint32_t* vertex_triangles = temp_arena.push_array<uint32_t>(index_count);
+    memset(offsets, 0, (vertex_count + 1) * sizeof(uint32_t));
+    for (size_t i = 0; i < index_count; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        offsets[vertex + 1] += offsets[vertex];
+    }
+    uint32_t* fill = temp_arena.push_array<uint32_t>(vertex_count);
+    memcpy(fill, offsets, vertex_count * sizeof(uint32_t));
+    for (size_t i = 0; i < index_count; i++) {
+        vertex_triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    uint8_t* is_emitted = temp_arena.push_array<uint8_t>(triangle_count);
+    uint8_t* local_indices = temp_arena.push_array<uint8_t>(vertex_count);
+    memset(is_emitted, 0, triangle_count);
+    memset(local_indices, no_local_index, vertex_count);
+
+    const uint32_t first_meshlet = static_cast<uint32_t>(meshlets.size());
+    Meshlet meshlet{};
+    const auto start_meshlet = [&] {
+        while (meshlet_triangles.size() % 4 != 0) {
+            meshlet_triangles.push_back(0);
+        }
+        meshlet = {};
+        meshlet.vertex_offset = static_cast<uint32_t>(meshlet_vertices.size());
+        meshlet.triangle_offset = static_cast<uint32_t>(meshlet_triangles.size());
+    };
+    const auto finish_meshlet = [&] {
+        for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+            local_indices[meshlet_vertices[meshlet.vertex_offset + i]] = no_local_index;
+        }
+        compute_meshlet_bounds(meshlet, meshlet_vertices.data(), meshlet_triangles.data(), positions, position_stride);
+        meshlets.push_back(meshlet);
+    };
+    const auto get_new_vertex_count = [&](uint32_t triangle) {
+        uint32_t count = 0;
+        for (size_t corner = 0; corner < 3; corner++) {
+            count += local_indices[indices[triangle * 3 + corner]] == no_local_index ? 1 : 0;
+        }
+        return count;
+    };
+
+    start_meshlet();
+    size_t next_unemitted = 0;
+    for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++) {
+        // The neighbour adding the fewest vertices, earliest in index order on a tie
+        uint32_t best_triangle = UINT32_MAX;
+        uint32_t best_new_count = 4;
+        for (uint32_t i = 0; i < meshlet.vertex_count && best_new_count > 0; i++) {
+            const uint32_t vertex = meshlet_vertices[meshlet.vertex_offset + i];
+            for (uint32_t j = offsets[vertex]; j < offsets[vertex + 1]; j++) {
+                const uint32_t triangle = vertex_triangles[j];
+                if (is_emitted[triangle] != 0) {
+                    continue;
+                }
+                const uint32_t new_count = get_new_vertex_count(triangle);
+                if (new_count < best_new_count || (new_count == best_new_count && triangle < best_triangle)) {
+                    best_triangle = triangle;
+                    best_new_count = new_count;
+                }
+            }
+        }
+        if (best_triangle == UINT32_MAX) {
+            while (is_emitted[next_unemitted] != 0) {
+                next_unemitted++;
+            }
+            best_triangle = static_cast<uint32_t>(next_unemitted);
+            best_new_count = get_new_vertex_count(best_triangle);
+        }
+        if (meshlet.triangle_count == MAX_MESHLET_TRIANGLES || meshlet.vertex_count + best_new_count > MAX_MESHLET_VERTICES) {
+            finish_meshlet();
+            start_meshlet();
+        }
+
+        is_emitted[best_triangle] = 1;
+        for (size_t corner = 0; corner < 3; corner++) {
+            const uint32_t vertex = indices[best_triangle * 3 + corner];
+            if (local_indices[vertex] == no_local_index) {
+                local_indices[vertex] = static_cast<uint8_t>(meshlet.vertex_count++);
+                meshlet_vertices.push_back(vertex);
+            }
+            meshlet_triangles.push_back(local_indices[vertex]);
+        }
+        meshlet.triangle_count++;
+    }
+    finish_meshlet();
+    return static_cast<uint32_t>(meshlets.size()) - first_meshlet;
+}
+
+void compute_meshlet_bounds(Meshlet& meshlet, const uint32_t* meshlet_vertices, const uint8_t* meshlet_triangles, const float* positions, size_t position_stride) {
+    const uint32_t* vertices = meshlet_vertices + meshlet.vertex_offset;
+    const uint8_t* triangles = meshlet_triangles + meshlet.triangle_offset;
+
+    glm::vec3 bounds_min = get_position(positions, position_stride, vertices[0]);
+    glm::vec3 bounds_max = bounds_min;
+    for (uint32_t i = 1; i < meshlet.vertex_count; i++) {
+        const glm::vec3 position = get_position(positions, position_stride, vertices[i]);
+        bounds_min = glm::min(bounds_min, position);
+        bounds_max = glm::max(bounds_max, position);
+    }
+    meshlet.center = (bounds_min + bounds_max) * 0.5f;
+    meshlet.radius = 0.f;
+    for (uint32_t i = 0; i < meshlet.vertex_count; i++) {
+        meshlet.radius = std::max(meshlet.radius, glm::length(get_position(positions, position_stride, vertices[i]) - meshlet.center));
+    }
+
+    // The axis averages the triangle normals, the cutoff is the sine of the
+    // widest angle any of them makes with it
+    glm::vec3 normals[MAX_MESHLET_TRIANGLES];
+    glm::vec3 corners[MAX_MESHLET_TRIANGLES];
+    uint32_t normal_count = 0;
+    glm::vec3 normal_sum{0.f};
+    for (uint32_t triangle = 0; triangle < meshlet.triangle_count; triangle++) {
+        const glm::vec3 a = get_position(positions, position_stride, vertices[triangles[triangle * 3]]);
+        const glm::vec3 b = get_position(positions, position_stride, vertices[triangles[triangle * 3 + 1]]);
+        const glm::vec3 c = get_position(positions, position_stride, vertices[triangles[triangle * 3 + 2]]);
+        const glm::vec3 normal = glm::cross(b - a, c - a);
+        const float length = glm::length(normal);
+        if (length == 0.f) {
+            continue;
+        }
+        normals[normal_count] = normal / length;
+        corners[normal_count] = a;
+        normal_sum += normals[normal_count];
+        normal_count++;
+    }
+    meshlet.cone_apex = meshlet.center;
+    meshlet.cone_axis = {0.f, 0.f, 0.f};
+    meshlet.cone_cutoff = 1.f;
+    meshlet.padding = 0.f;
+    const float sum_length = glm::length(normal_sum);
+    if (normal_count == 0 || sum_length == 0.f) {
+        return;
+    }
+    const glm::vec3 axis = normal_sum / sum_length;
+    float min_dot = 1.f;
+    for (uint32_t i = 0; i < normal_count; i++) {
+        min_dot = std::min(min_dot, glm::dot(axis, normals[i]));
+    }
+    if (min_dot < min_cone_dot) {
+        return;
+    }
+    // Pulls the apex back along the axis until every triangle's plane has
+    // it on the back side
+    float max_distance = 0.f;
+    for (uint32_t i = 0; i < normal_count; i++) {
+        const float distance = glm::dot(meshlet.center - corners[i], normals[i]) / glm::dot(axis, normals[i]);
+        max_distance = std::max(max_distance, distance);
+    }
+    meshlet.cone_apex = meshlet.center - axis * max_distance;
+    meshlet.cone_axis = axis;
+    meshlet.cone_cutoff = std::sqrt(1.f - min_dot * min_dot);
+}
+
+void get_frustum_planes(const glm::mat4& transform, glm::vec4 planes[6]) {
+    const glm::vec4 row_x{transform[0][0], transform[1][0], transform[2][0], transform[3][0]};
+    const glm::vec4 row_y{transform[0][1], transform[1][1], transform[2][1], transform[3][1]};
+    const glm::vec4 row_z{transform[0][2], transform[1][2], transform[2][2], transform[3][2]};
+    const glm::vec4 row_w{transform[0][3], transform[1][3], transform[2][3], transform[3][3]};
+    // Vulkan depth runs from 0 to w
+    planes[0] = row_w + row_x;
+    planes[1] = row_w - row_x;
+    planes[2] = row_w + row_y;
+    planes[3] = row_w - row_y;
+    planes[4] = row_z;
+    planes[5] = row_w - row_z;
+    for (size_t i = 0; i < 6; i++) {
+        planes[i] /= glm::length(glm::vec3{planes[i]});
+    }
+}
+
+bool is_meshlet_outside(const Meshlet& meshlet, const glm::vec4 planes[6]) {
+    for (size_t i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec3{planes[i]}, meshlet.center) + planes[i].w < -meshlet.radius) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool is_meshlet_backfacing(const Meshlet& meshlet, const glm::vec3& camera_position) {
+    const glm::vec3 view = meshlet.cone_apex - camera_position;
+    const float distance = glm::length(view);
+    return distance > 0.f && glm::dot(view, meshlet.cone_axis) >= meshlet.cone_cutoff * distance;
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include "Containers/DynArray.h"
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+// Limits that fit a mesh shader workgroup's output
+constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+// A small cluster of triangles with its own vertex list. The triangles index
+// that list with one byte per corner.
+struct Meshlet {
+    // Into the meshlet vertices and meshlet triangles, the second in bytes
+    uint32_t vertex_offset;
+    uint32_t triangle_offset;
+    uint32_t vertex_count;
+    uint32_t triangle_count;
+    glm::vec3 center;
+    float radius;
+    // Every triangle faces away from a viewer inside the cone behind the
+    // apex, see is_meshlet_backfacing. A cutoff of 1 never culls.
+    glm::vec3 cone_apex;
+    float cone_cutoff;
+    glm::vec3 cone_axis;
+    float padding;
+};
+
+// Splits a triangle list into meshlets of at most MAX_MESHLET_VERTICES and
+// MAX_MESHLET_TRIANGLES. Each meshlet grows by the neighbouring triangle
+// adding the fewest vertices, or the next one in index order once it has no
+// neighbours left, so cache optimized indices give compact meshlets. Appends to the three arrays
+// with bounds filled in and returns how many meshlets it added. Every
+// meshlet's triangles start 4 byte aligned.
+uint32_t build_meshlets(Arena& temp_arena, const uint32_t* indices, size_t index_count, const float* positions, size_t position_stride, size_t vertex_count,
+    DynArray<Meshlet>& meshlets, DynArray<uint32_t>& meshlet_vertices, DynArray<uint8_t>& meshlet_triangles);
+// Bounding sphere and normal cone of a meshlet whose ranges are already set
+void compute_meshlet_bounds(Meshlet& meshlet, const uint32_t* meshlet_vertices, const uint8_t* meshlet_triangles, const float* positions, size_t position_stride);
+
+// Planes of the view volume pointing inwards, from a matrix taking a space
+// to Vulkan clip space. Culling then works in that space.
+void get_frustum_planes(const glm::mat4& transform, glm::vec4 planes[6]);
+// True when the meshlet's sphere is completely behind one of the planes
+bool is_meshlet_outside(const Meshlet& meshlet, const glm::vec4 planes[6]);
+// True when every triangle of the meshlet faces away from camera_position,
+// both in the meshlet's space
+bool is_meshlet_backfacing(const Meshlet& meshlet, const glm::vec3& camera_position);
+
+}
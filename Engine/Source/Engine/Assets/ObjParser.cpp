@@ -0,0 +1,369 @@
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+
+#include "Engine/Profiling/Profiler.h"
+
+namespace engine::assets {
+
+namespace {
+
+// Files smaller than this parse serially, bigger ones get chunks of at least
+// half of it
+constexpr size_t min_chunk_size = 1 << 20;
+constexpr size_t max_chunks = jobs::MAX_PARALLEL_FOR_BATCHES;
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skip_spaces(const char* cursor, const char* end) {
+    while (cursor < end && is_space(*cursor)) {
+        cursor++;
+    }
+    return cursor;
+}
+
+const char* skip_line(const char* cursor, const char* end) {
+    while (cursor < end && *cursor != '\n') {
+        cursor++;
+    }
+    return cursor;
+}
+
+// from_chars doesn't take a leading plus, OBJ exporters occasionally write one
+bool parse_float(const char*& cursor, const char* end, float& value) {
+    cursor = skip_spaces(cursor, end);
+    if (cursor < end && *cursor == '+') {
+        cursor++;
+    }
+    const std::from_chars_result result = std::from_chars(cursor, end, value);
+    if (result.ec != std::errc{}) {
+        return false;
+    }
+    cursor = result.ptr;
+    return true;
+}
+
+// Resolves a one based or negative, relative OBJ index against count
+bool parse_index(const char*& cursor, const char* end, size_t count, int32_t& index) {
+    bool is_negative = false;
+    if (cursor < end && *cursor == '-') {
+        is_negative = true;
+        cursor++;
+    }
+    if (cursor == end || *cursor < '0' || *cursor > '9') {
+        return false;
+    }
+    int64_t value = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
+    }
+    const int64_t resolved = is_negative ? static_cast<int64_t>(count) - value : value - 1;
+    if (value == 0 || resolved < 0 || resolved >= static_cast<int64_t>(count)) {
+        return false;
+    }
+    index = static_cast<int32_t>(resolved);
+    return true;
+}
+
+// What a line starts with, cursor is moved past the directive
+enum class Directive : uint8_t {
+    POSITION,
+    UV,
+    NORMAL,
+    FACE,
+    OTHER,
+};
+
+Directive read_directive(const char*& cursor, const char* end) {
+    if (cursor + 1 < end && cursor[0] == 'v' && is_space(cursor[1])) {
+        cursor += 1;
+        return Directive::POSITION;
+    }
+    if (cursor + 2 < end && cursor[0] == 'v' && cursor[1] == 't' && is_space(cursor[2])) {
+        cursor += 2;
+        return Directive::UV;
+    }
+    if (cursor + 2 < end && cursor[0] == 'v' && cursor[1] == 'n' && is_space(cursor[2])) {
+        cursor += 2;
+        return Directive::NORMAL;
+    }
+    if (cursor + 1 < end && cursor[0] == 'f' && is_space(cursor[1])) {
+        cursor += 1;
+        return Directive::FACE;
+    }
+    return Directive::OTHER;
+}
+
+// Appends to the caller's streams, the serial path
+struct StreamSink {
+    ObjStreams& streams;
+
+    [[nodiscard]] size_t get_position_count() const { return streams.positions.size(); }
+    [[nodiscard]] size_t get_uv_count() const { return streams.uvs.size(); }
+    [[nodiscard]] size_t get_normal_count() const { return streams.normals.size(); }
+
+    void add_position(const glm::vec3& position, const glm::vec3& color) {
+        streams.positions.push_back(position);
+        streams.colors.push_back(color);
+    }
+    void add_uv(const glm::vec2& uv) { streams.uvs.push_back(uv); }
+    void add_normal(const glm::vec3& normal) { streams.normals.push_back(normal); }
+    void add_triangle(const ObjCorner& a, const ObjCorner& b, const ObjCorner& c) {
+        streams.corners.push_back(a);
+        streams.corners.push_back(b);
+        streams.corners.push_back(c);
+    }
+};
+
+// Writes one chunk into its slice of presized streams. Counts start at the
+// totals of the chunks before it, which is all relative indices need.
+struct SliceSink {
+    ObjStreams& streams;
+    ObjCounts next;
+
+    [[nodiscard]] size_t get_position_count() const { return next.positions; }
+    [[nodiscard]] size_t get_uv_count() const { return next.uvs; }
+    [[nodiscard]] size_t get_normal_count() const { return next.normals; }
+
+    void add_position(const glm::vec3& position, const glm::vec3& color) {
+        streams.positions[next.positions] = position;
+        streams.colors[next.positions] = color;
+        next.positions++;
+    }
+    void add_uv(const glm::vec2& uv) { streams.uvs[next.uvs++] = uv; }
+    void add_normal(const glm::vec3& normal) { streams.normals[next.normals++] = normal; }
+    void add_triangle(const ObjCorner& a, const ObjCorner& b, const ObjCorner& c) {
+        const size_t corner = next.triangles * 3;
+        streams.corners[corner + 0] = a;
+        streams.corners[corner + 1] = b;
+        streams.corners[corner + 2] = c;
+        next.triangles++;
+    }
+};
+
+template <typename Sink>
+bool parse_corner(const char*& cursor, const char* end, const Sink& sink, ObjCorner& corner) {
+    corner = {ObjCorner::NO_INDEX, ObjCorner::NO_INDEX, ObjCorner::NO_INDEX};
+    if (!parse_index(cursor, end, sink.get_position_count(), corner.position)) {
+        return false;
+    }
+    if (cursor == end || *cursor != '/') {
+        return true;
+    }
+    cursor++;
+    // v//vn leaves the uv out
+    if (cursor < end && *cursor != '/' && !parse_index(cursor, end, sink.get_uv_count(), corner.uv)) {
+        return false;
+    }
+    if (cursor == end || *cursor != '/') {
+        return true;
+    }
+    cursor++;
+    return parse_index(cursor, end, sink.get_normal_count(), corner.normal);
+}
+
+template <typename Sink>
+bool parse_face(const char*& cursor, const char* end, Sink& sink) {
+    ObjCorner first{};
+    ObjCorner previous{};
+    uint32_t corner_count = 0;
+    while (true) {
+        cursor = skip_spaces(cursor, end);
+        if (cursor == end || *cursor == '\n' || *cursor == '#') {
+            break;
+        }
+        ObjCorner corner{};
+        if (!parse_corner(cursor, end, sink, corner)) {
+            return false;
+        }
+        if (corner_count == 0) {
+            first = corner;
+        } else if (corner_count >= 2) {
+            sink.add_triangle(first, previous, corner);
+        }
+        previous = corner;
+        corner_count++;
+    }
+    return corner_count >= 3;
+}
+
+template <typename Sink>
+bool parse_vertex(const char*& cursor, const char* end, Sink& sink) {
+    glm::vec3 position;
+    if (!parse_float(cursor, end, position.x) || !parse_float(cursor, end, position.y) || !parse_float(cursor, end, position.z)) {
+        return false;
+    }
+    glm::vec3 color{1.f, 1.f, 1.f};
+    // Either nothing, a w or an rgb color follows
+    float r;
+    const char* color_cursor = cursor;
+    if (parse_float(color_cursor, end, r)) {
+        glm::vec3 parsed_color{r, 0.f, 0.f};
+        if (parse_float(color_cursor, end, parsed_color.y) && parse_float(color_cursor, end, parsed_color.z)) {
+            color = parsed_color;
+        }
+    }
+    sink.add_position(position, color);
+    return true;
+}
+
+template <typename Sink>
+bool parse_lines(const char* text, size_t size, Sink& sink) {
+    const char* cursor = text;
+    const char* end = text + size;
+    while (cursor < end) {
+        cursor = skip_spaces(cursor, end);
+        switch (read_directive(cursor, end)) {
+            case Directive::POSITION:
+                if (!parse_vertex(cursor, end, sink)) {
+                    return false;
+                }
+                break;
+            case Directive::UV: {
+                glm::vec2 uv;
+                if (!parse_float(cursor, end, uv.x) || !parse_float(cursor, end, uv.y)) {
+                    return false;
+                }
+                sink.add_uv(uv);
+                break;
+            }
+            case Directive::NORMAL: {
+                glm::vec3 normal;
+                if (!parse_float(cursor, end, normal.x) || !parse_float(cursor, end, normal.y) || !parse_float(cursor, end, normal.z)) {
+                    return false;
+                }
+                sink.add_normal(normal);
+                break;
+            }
+            case Directive::FACE:
+                if (!parse_face(cursor, end, sink)) {
+                    return false;
+                }
+                break;
+            case Directive::OTHER:
+                break;
+        }
+        cursor = skip_line(cursor, end);
+        if (cursor < end) {
+            cursor++;
+        }
+    }
+    return true;
+}
+
+// Counts what parse_lines would write without converting any numbers
+ObjCounts count_lines(const char* text, size_t size) {
+    ObjCounts counts{};
+    const char* cursor = text;
+    const char* end = text + size;
+    while (cursor < end) {
+        cursor = skip_spaces(cursor, end);
+        switch (read_directive(cursor, end)) {
+            case Directive::POSITION:
+                counts.positions++;
+                break;
+            case Directive::UV:
+                counts.uvs++;
+                break;
+            case Directive::NORMAL:
+                counts.normals++;
+                break;
+            case Directive::FACE: {
+                size_t corner_count = 0;
+                while (true) {
+                    cursor = skip_spaces(cursor, end);
+                    if (cursor == end || *cursor == '\n' || *cursor == '#') {
+                        break;
+                    }
+                    while (cursor < end && !is_space(*cursor) && *cursor != '\n' && *cursor != '#') {
+                        cursor++;
+                    }
+                    corner_count++;
+                }
+                counts.triangles += corner_count >= 3 ? corner_count - 2 : 0;
+                break;
+            }
+            case Directive::OTHER:
+                break;
+        }
+        cursor = skip_line(cursor, end);
+        if (cursor < end) {
+            cursor++;
+        }
+    }
+    return counts;
+}
+
+}
+
+ObjStreams::ObjStreams(Arena& arena) : positions(arena), colors(arena), normals(arena), uvs(arena), corners(arena) {
+}
+
+bool parse_obj(const char* text, size_t size, ObjStreams& streams) {
+    StreamSink sink{streams};
+    return parse_lines(text, size, sink);
+}
+
+bool parse_obj_parallel(jobs::JobSystem& job_system, const char* text, size_t size, ObjStreams& streams) {
+    const size_t chunk_count = std::min({(size + min_chunk_size - 1) / min_chunk_size, static_cast<size_t>(job_system.get_thread_count()) * 4, max_chunks});
+    if (chunk_count <= 1 || job_system.get_thread_count() == 1) {
+        return parse_obj(text, size, streams);
+    }
+    PROFILE_ZONE("parse_obj_parallel");
+
+    // Chunks end after a newline, so no line is split between two of them
+    const char* chunk_begins[max_chunks + 1];
+    chunk_begins[0] = text;
+    for (size_t chunk = 1; chunk < chunk_count; chunk++) {
+        const char* boundary = std::max(text + size * chunk / chunk_count, chunk_begins[chunk - 1]);
+        boundary = skip_line(boundary, text + size);
+        chunk_begins[chunk] = boundary < text + size ? boundary + 1 : boundary;
+    }
+    chunk_begins[chunk_count] = text + size;
+
+    ObjCounts chunk_counts[max_chunks + 1];
+    job_system.parallel_for(chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++) {
+            chunk_counts[chunk] = count_lines(chunk_begins[chunk], chunk_begins[chunk + 1] - chunk_begins[chunk]);
+        }
+    });
+
+    // Turn the counts into each chunk's first slot and size the streams once
+    ObjCounts total{};
+    for (size_t chunk = 0; chunk < chunk_count; chunk++) {
+        const ObjCounts counts = chunk_counts[chunk];
+        chunk_counts[chunk] = total;
+        total.positions += counts.positions;
+        total.uvs += counts.uvs;
+        total.normals += counts.normals;
+        total.triangles += counts.triangles;
+    }
+    chunk_counts[chunk_count] = total;
+    streams.positions.push_back_n({}, total.positions);
+    streams.colors.push_back_n({}, total.positions);
+    streams.uvs.push_back_n({}, total.uvs);
+    streams.normals.push_back_n({}, total.normals);
+    streams.corners.push_back_n({}, total.triangles * 3);
+
+    std::atomic<bool> is_valid{true};
+    job_system.parallel_for(chunk_count, 1, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; chunk++) {
+            SliceSink sink{streams, chunk_counts[chunk]};
+            const ObjCounts& expected = chunk_counts[chunk + 1];
+            const bool is_chunk_valid = parse_lines(chunk_begins[chunk], chunk_begins[chunk + 1] - chunk_begins[chunk], sink) &&
+                sink.next.positions == expected.positions && sink.next.uvs == expected.uvs &&
+                sink.next.normals == expected.normals && sink.next.triangles == expected.triangles;
+            if (!is_chunk_valid) {
+                is_valid.store(false, std::memory_order_relaxed);
+            }
+        }
+    });
+    return is_valid.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include "Containers/DynArray.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+// One triangle corner. Indices are zero based into the streams, NO_INDEX
+// where the face didn't reference that attribute.
+struct ObjCorner {
+    static constexpr int32_t NO_INDEX = -1;
+
+    int32_t position;
+    int32_t uv;
+    int32_t normal;
+};
+
+// Attribute streams of an OBJ in file order. colors always matches positions,
+// vertices without a color get white like tinyobjloader gives them.
+struct ObjStreams {
+    DynArray<glm::vec3> positions;
+    DynArray<glm::vec3> colors;
+    DynArray<glm::vec3> normals;
+    DynArray<glm::vec2> uvs;
+    // Faces fan triangulated, three corners per triangle
+    DynArray<ObjCorner> corners;
+
+    explicit ObjStreams(Arena& arena);
+};
+
+struct ObjCounts {
+    size_t positions;
+    size_t uvs;
+    size_t normals;
+    size_t triangles;
+};
+
+// Single pass over OBJ text. Only v, vt, vn and f are read, every other
+// directive is skipped. False on a malformed number or an index outside the
+// streams.
+bool parse_obj(const char* text, size_t size, ObjStreams& streams);
+// Same result as parse_obj. Large files are split on line boundaries and the
+// chunks are counted first, so every chunk parses straight into its own
+// slice of the streams on the job system and nothing has to be merged.
+bool parse_obj_parallel(jobs::JobSystem& job_system, const char* text, size_t size, ObjStreams& streams);
+
+}
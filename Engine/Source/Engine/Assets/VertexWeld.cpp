@@ -0,0 +1,114 @@
+#include "VertexWeld.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace engine::assets {
+
+namespace {
+
+constexpr uint32_t empty_slot = UINT32_MAX;
+constexpr size_t min_table_size = 16;
+
+// The hash is kept next to the index so most mismatches never touch the
+// vertex itself
+struct WeldSlot {
+    uint32_t hash;
+    uint32_t index;
+};
+
+int32_t snap(float value, float inverse_epsilon) {
+    if (std::isnan(value)) {
+        return INT32_MIN;
+    }
+    // Clamped below 2^31 so the conversion can't overflow
+    constexpr float limit = 2147483520.f;
+    const float scaled = std::floor(value * inverse_epsilon + 0.5f);
+    return static_cast<int32_t>(scaled < -limit ? -limit : scaled > limit ? limit : scaled);
+}
+
+}
+
+uint32_t hash_words(const void* data, size_t size) {
+    assert(size % sizeof(uint32_t) == 0 && "Hashed size has to be whole words");
+    constexpr uint32_t prime = 0x9e3779b1u;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    const size_t word_count = size / sizeof(uint32_t);
+    uint32_t lanes[4] = {0x85ebca6bu, 0xc2b2ae35u, 0x27d4eb2fu, 0x165667b1u};
+    size_t word = 0;
+    for (; word + 4 <= word_count; word += 4) {
+        uint32_t words[4];
+        memcpy(words, bytes + word * sizeof(uint32_t), sizeof(words));
+        for (size_t lane = 0; lane < 4; lane++) {
+            lanes[lane] = (lanes[lane] ^ words[lane]) * prime;
+            lanes[lane] ^= lanes[lane] >> 15;
+        }
+    }
+    for (size_t lane = 0; word < word_count; word++, lane++) {
+        uint32_t value;
+        memcpy(&value, bytes + word * sizeof(uint32_t), sizeof(value));
+        lanes[lane] = (lanes[lane] ^ value) * prime;
+    }
+    uint64_t hash = (static_cast<uint64_t>(lanes[0] ^ lanes[2]) << 32 | (lanes[1] ^ lanes[3])) * 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return static_cast<uint32_t>(hash ^ size);
+}
+
+uint32_t weld_vertices(Arena& temp_arena, const void* vertices, size_t vertex_count, size_t stride, size_t key_size, float epsilon, uint32_t* remap) {
+    assert(key_size <= stride && key_size % sizeof(float) == 0 && "Key has to be whole floats inside the vertex");
+    if (vertex_count == 0) {
+        return 0;
+    }
+    const auto* vertex_bytes = static_cast<const uint8_t*>(vertices);
+    size_t key_stride = stride;
+    // Snapped keys are compared instead of the vertices when welding with a tolerance
+    if (epsilon > 0.f) {
+        const float inverse_epsilon = 1.f / epsilon;
+        const size_t float_count = key_size / sizeof(float);
+        auto* snapped = static_cast<int32_t*>(temp_arena.push(vertex_count * key_size, alignof(int32_t)));
+        assert(snapped != nullptr && "Temp arena is too small for the snapped keys");
+        for (size_t i = 0; i < vertex_count; i++) {
+            for (size_t component = 0; component < float_count; component++) {
+                float value;
+                memcpy(&value, vertex_bytes + i * stride + component * sizeof(float), sizeof(value));
+                snapped[i * float_count + component] = snap(value, inverse_epsilon);
+            }
+        }
+        vertex_bytes = reinterpret_cast<const uint8_t*>(snapped);
+        key_stride = key_size;
+    }
+
+    // At most half full, so probe runs stay short
+    size_t table_size = min_table_size;
+    while (table_size < vertex_count * 2) {
+        table_size *= 2;
+    }
+    const size_t mask = table_size - 1;
+    auto* slots = static_cast<WeldSlot*>(temp_arena.push(table_size * sizeof(WeldSlot), alignof(WeldSlot)));
+    assert(slots != nullptr && "Temp arena is too small for the weld table");
+    memset(slots, 0xff, table_size * sizeof(WeldSlot));
+
+    uint32_t unique_count = 0;
+    for (size_t i = 0; i < vertex_count; i++) {
+        const uint8_t* key = vertex_bytes + i * key_stride;
+        const uint32_t hash = hash_words(key, key_size);
+        size_t slot = hash & mask;
+        while (true) {
+            WeldSlot& entry = slots[slot];
+            if (entry.index == empty_slot) {
+                entry = {hash, static_cast<uint32_t>(i)};
+                remap[i] = unique_count++;
+                break;
+            }
+            if (entry.hash == hash && memcmp(vertex_bytes + entry.index * key_stride, key, key_size) == 0) {
+                remap[i] = remap[entry.index];
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+    return unique_count;
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Memory/Arena.h"
+
+namespace engine::assets {
+
+// Hashes size bytes as 32 bit words in four independent lanes, which the
+// compiler turns into vector multiplies. size has to be a multiple of 4.
+uint32_t hash_words(const void* data, size_t size);
+
+// Gives every vertex the index of the first earlier vertex whose first
+// key_size bytes match its own, in remap, and returns the number of distinct
+// vertices. Indices count up in order of first appearance, so vertex i is
+// new exactly when remap[i] equals the count seen so far.
+// With epsilon above zero the key is read as floats snapped to a grid of
+// that spacing. Vertices closer than epsilon then weld unless a grid line
+// falls between them.
+uint32_t weld_vertices(Arena& temp_arena, const void* vertices, size_t vertex_count, size_t stride, size_t key_size, float epsilon, uint32_t* remap);
+
+}
@@ -0,0 +1,48 @@
+#include "CommandBuffer.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "World.h"
+
+namespace ecs {
+
+CommandBuffer::CommandBuffer(World* world, size_t arena_size) : m_world_(world), m_arena_(arena_size), m_commands_(m_arena_) {
+    
+}
+
+void* CommandBuffer::copy_component(const void* component, size_t size, size_t alignment) {
+    void* data = m_arena_.push(size, alignment);
+    assert(data != nullptr && "Command buffer arena is full");
+    memcpy(data, component, size);
+    return data;
+}
+
+entity_t CommandBuffer::create(component_set signature) {
+    return create(1, signature).first;
+}
+
+EntityRange CommandBuffer::create(size_t count, component_set signature) {
+    const EntityRange range = m_world_->reserve_entities(count);
+    m_commands_.push_back({.type = CommandType::CREATE, .component = {}, .entities = range, .signature = signature, .data = nullptr});
+    return range;
+}
+
+void CommandBuffer::destroy(entity_t entity) {
+    m_commands_.push_back({.type = CommandType::DESTROY, .component = {}, .entities = {entity, 1}, .signature = {}, .data = nullptr});
+}
+
+const DynArray<CommandBuffer::Command>& CommandBuffer::get_commands() const {
+    return m_commands_;
+}
+
+bool CommandBuffer::is_empty() const {
+    return m_commands_.is_empty();
+}
+
+void CommandBuffer::clear() {
+    m_commands_.clear();
+    m_arena_.clear();
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ComponentTraits.h"
+#include "ECSTypes.h"
+#include "Containers/DynArray.h"
+#include "Memory/Arena.h"
+
+namespace ecs {
+
+class World;
+
+// Records structural changes so systems never create, destroy, add or remove
+// while the world is being iterated. Each thread records into its own buffer
+// and World::flush_command_buffers applies all of them at a sync point.
+class CommandBuffer {
+public:
+    enum class CommandType : uint8_t {
+        CREATE,
+        DESTROY,
+        ADD,
+        REMOVE,
+    };
+
+    struct Command {
+        CommandType type;
+        // Only read by ADD and REMOVE
+        ComponentType component;
+        EntityRange entities;
+        component_set signature;
+        // Copy of the component for ADD, lives in the buffer's arena
+        const void* data;
+    };
+private:
+    World* m_world_;
+    Arena m_arena_;
+    DynArray<Command> m_commands_;
+
+    void* copy_component(const void* component, size_t size, size_t alignment);
+public:
+    CommandBuffer(World* world, size_t arena_size);
+    ~CommandBuffer() = default;
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+    CommandBuffer(CommandBuffer&&) = delete;
+    CommandBuffer& operator=(CommandBuffer&&) = delete;
+
+    // Ids are reserved right away so later commands can refer to the entity,
+    // but it does not exist in the world until the buffer is flushed.
+    entity_t create(component_set signature);
+    EntityRange create(size_t count, component_set signature);
+    void destroy(entity_t entity);
+    template <typename T>
+    void add(entity_t entity, const T& component);
+    template <typename T>
+    void remove(entity_t entity);
+
+    [[nodiscard]] const DynArray<Command>& get_commands() const;
+    [[nodiscard]] bool is_empty() const;
+    void clear();
+};
+
+template <typename T>
+void CommandBuffer::add(entity_t entity, const T& component) {
+    const void* data = copy_component(&component, sizeof(T), alignof(T));
+    m_commands_.push_back({.type = CommandType::ADD, .component = ComponentTraits<T>::type, .entities = {entity, 1}, .signature = {}, .data = data});
+}
+
+template <typename T>
+void CommandBuffer::remove(entity_t entity) {
+    m_commands_.push_back({.type = CommandType::REMOVE, .component = ComponentTraits<T>::type, .entities = {entity, 1}, .signature = {}, .data = nullptr});
+}
+
+}
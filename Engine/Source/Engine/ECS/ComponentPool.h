@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+
+#include "ECSTypes.h"
+#include "Containers/DynArray.h"
+#include "Memory/Arena.h"
+
+namespace ecs {
+
+constexpr size_t invalid_component_index = std::numeric_limits<size_t>::max();
+
+// Sparse set storage for a single component type. Components are kept densely
+// packed so systems can iterate them linearly, and m_sparse_ maps an entity
+// id to its slot in the dense arrays.
+template <typename T>
+class ComponentPool {
+    DynArray<T> m_components_;
+    DynArray<entity_t> m_entities_;
+    DynArray<size_t> m_sparse_;
+
+    void grow_sparse(entity_t last_entity);
+public:
+    explicit ComponentPool(Arena& arena);
+    ~ComponentPool() = default;
+
+    ComponentPool(const ComponentPool&) = delete;
+    ComponentPool& operator=(const ComponentPool&) = delete;
+    ComponentPool(ComponentPool&&) = delete;
+    ComponentPool& operator=(ComponentPool&&) = delete;
+
+    [[nodiscard]] bool contains(entity_t entity) const;
+    [[nodiscard]] size_t size() const;
+    T& get(entity_t entity);
+
+    T& insert(entity_t entity, const T& component);
+    // Adds the same component to every entity in the range with one bulk fill.
+    // The range is laid out contiguously, so the returned pointer can be used to
+    // overwrite all of its components until the next structural change.
+    T* insert_range(EntityRange range, const T& component);
+    void remove(entity_t entity);
+    // Removes every listed entity the pool contains. Slots are freed from the
+    // back, so each swap moves a live component and nothing is moved twice.
+    void remove_batch(Arena& temp_arena, const entity_t* entities, size_t count);
+
+    T* data() const;
+    entity_t* entities() const;
+};
+
+template <typename T>
+ComponentPool<T>::ComponentPool(Arena& arena) : m_components_(arena), m_entities_(arena), m_sparse_(arena) {
+    
+}
+
+template <typename T>
+void ComponentPool<T>::grow_sparse(entity_t last_entity) {
+    if (last_entity >= m_sparse_.size()) {
+        m_sparse_.push_back_n(invalid_component_index, last_entity + 1 - m_sparse_.size());
+    }
+}
+
+template <typename T>
+bool ComponentPool<T>::contains(entity_t entity) const {
+    return entity < m_sparse_.size() && m_sparse_[entity] != invalid_component_index;
+}
+
+template <typename T>
+size_t ComponentPool<T>::size() const {
+    return m_components_.size();
+}
+
+template <typename T>
+T& ComponentPool<T>::get(entity_t entity) {
+    return m_components_[m_sparse_[entity]];
+}
+
+template <typename T>
+T& ComponentPool<T>::insert(entity_t entity, const T& component) {
+    if (contains(entity)) {
+        T& existing = get(entity);
+        existing = component;
+        return existing;
+    }
+    grow_sparse(entity);
+    m_sparse_[entity] = m_components_.size();
+    m_components_.push_back(component);
+    m_entities_.push_back(entity);
+    return m_components_[m_components_.size() - 1];
+}
+
+template <typename T>
+T* ComponentPool<T>::insert_range(EntityRange range, const T& component) {
+    if (range.count == 0) {
+        return nullptr;
+    }
+    grow_sparse(range.first + range.count - 1);
+    const size_t first_index = m_components_.size();
+    m_components_.push_back_n(component, range.count);
+    m_entities_.reserve(first_index + range.count);
+    for (size_t i = 0; i < range.count; i++) {
+        m_sparse_[range.first + i] = first_index + i;
+        m_entities_.push_back(range.first + i);
+    }
+    return m_components_.data() + first_index;
+}
+
+template <typename T>
+void ComponentPool<T>::remove(entity_t entity) {
+    if (!contains(entity)) {
+        return;
+    }
+    // Swap the last component into the hole to keep the storage dense
+    const size_t index = m_sparse_[entity];
+    const size_t last_index = m_components_.size() - 1;
+    if (index != last_index) {
+        const entity_t last_entity = m_entities_[last_index];
+        m_components_[index] = m_components_[last_index];
+        m_entities_[index] = last_entity;
+        m_sparse_[last_entity] = index;
+    }
+    m_components_.pop_back();
+    m_entities_.pop_back();
+    m_sparse_[entity] = invalid_component_index;
+}
+
+template <typename T>
+void ComponentPool<T>::remove_batch(Arena& temp_arena, const entity_t* entities, size_t count) {
+    DynArray<size_t> indices{temp_arena};
+    indices.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (contains(entities[i])) {
+            indices.push_back(m_sparse_[entities[i]]);
+            m_sparse_[entities[i]] = invalid_component_index;
+        }
+    }
+    std::sort(indices.data(), indices.data() + indices.size(), std::greater<>());
+    for (const size_t index : indices) {
+        const size_t last_index = m_components_.size() - 1;
+        if (index != last_index) {
+            const entity_t last_entity = m_entities_[last_index];
+            m_components_[index] = m_components_[last_index];
+            m_entities_[index] = last_entity;
+            m_sparse_[last_entity] = index;
+        }
+        m_components_.pop_back();
+        m_entities_.pop_back();
+    }
+}
+
+template <typename T>
+T* ComponentPool<T>::data() const {
+    return m_components_.data();
+}
+
+template <typename T>
+entity_t* ComponentPool<T>::entities() const {
+    return m_entities_.data();
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ECSTypes.h"
+#include "Components/Components.h"
+
+namespace ecs {
+
+// Maps a component type to its bit in a component_set
+template <typename T>
+struct ComponentTraits;
+
+template <>
+struct ComponentTraits<components::Transform3D> {
+    static constexpr ComponentType type = TRANSFORM_3D_COMPONENT;
+};
+
+template <>
+struct ComponentTraits<components::Renderable> {
+    static constexpr ComponentType type = RENDERABLE_COMPONENT;
+};
+
+}
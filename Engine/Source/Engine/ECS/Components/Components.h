@@ -1,10 +1,13 @@
 ﻿#pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "Engine/Assets/AssetLoader.h"
 #include "Engine/Vulkan/VulkanModel.h"
 
 namespace components {
 
+// Local transform, relative to the entity's ChildOf parent if it has one
 struct Transform3D {
     glm::vec3 translation{};
     glm::vec3 rotation{0, 0, 0};
@@ -42,8 +45,75 @@ struct Transform3D {
     }
 };
 
+// Parent world matrix * Transform3D::as_matrix. Only rewritten for tables
+// whose transforms or parent changed since the transform system last ran.
+struct WorldMatrix {
+    glm::mat4 matrix{1.f};
+};
+
+// Translation, rotation and scale pulled back out of a world matrix, so poses
+// from two ticks can be blended. Assumes the matrix has no shear.
+struct WorldPose {
+    glm::vec3 translation{};
+    glm::quat rotation{1.f, 0.f, 0.f, 0.f};
+    glm::vec3 scale{1.f};
+
+    [[nodiscard]] static WorldPose from_matrix(const glm::mat4& matrix) {
+        const glm::vec3 x_axis{matrix[0]};
+        const glm::vec3 y_axis{matrix[1]};
+        const glm::vec3 z_axis{matrix[2]};
+        WorldPose pose;
+        pose.translation = glm::vec3{matrix[3]};
+        pose.scale = {glm::length(x_axis), glm::length(y_axis), glm::length(z_axis)};
+        // A mirrored basis can't be a rotation, fold the flip into the scale
+        if (glm::dot(glm::cross(x_axis, y_axis), z_axis) < 0.f) {
+            pose.scale.x = -pose.scale.x;
+        }
+        pose.rotation = glm::quat_cast(glm::mat3{x_axis / pose.scale.x, y_axis / pose.scale.y, z_axis / pose.scale.z});
+        return pose;
+    }
+
+    [[nodiscard]] static WorldPose interpolate(const WorldPose& from, const WorldPose& to, float alpha) {
+        return {
+            glm::mix(from.translation, to.translation, alpha),
+            glm::slerp(from.rotation, to.rotation, alpha),
+            glm::mix(from.scale, to.scale, alpha)
+        };
+    }
+
+    [[nodiscard]] glm::mat4 as_matrix() const {
+        glm::mat4 matrix = glm::mat4_cast(rotation);
+        matrix[0] *= scale.x;
+        matrix[1] *= scale.y;
+        matrix[2] *= scale.z;
+        matrix[3] = glm::vec4{translation, 1.f};
+        return matrix;
+    }
+};
+
+// Poses of the last two simulation ticks, only used when the simulation runs
+// on its own thread
+struct InterpolatedPose {
+    WorldPose previous;
+    WorldPose current;
+    bool has_previous = false;
+};
+
 struct Renderable {
     engine::vulkan::VulkanModel* model;
 };
 
+// Renderable still draws the loader's placeholder, swapped for the streamed
+// model and removed once the load is done
+struct PendingModel {
+    engine::assets::ModelHandle handle;
+};
+
+// Everything the record stage needs to issue a draw, built in parallel
+struct DrawPacket {
+    glm::mat4 transform{1.f};
+    engine::vulkan::VulkanModel* model = nullptr;
+    uint32_t lod = 0;
+};
+
 }
@@ -1,10 +1,23 @@
 ﻿#pragma once
 
 #include <bitset>
+#include <limits>
 
 namespace ecs {
 
 using entity_t = size_t;
 using component_set = std::bitset<32>;
 
+// Bit index of each built in component inside a component_set
+enum ComponentType : size_t {
+    TRANSFORM_3D_COMPONENT = 0,
+    RENDERABLE_COMPONENT = 1,
+};
+
+// Contiguous block of entity ids handed out by a batch creation
+struct EntityRange {
+    entity_t first;
+    size_t count;
+};
+
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 ﻿#include "EntityLookupTable.h"
 
+#include <algorithm>
+
 namespace ecs {
 
 entity_t EntityLookupTable::hash(entity_t entity) const {
@@ -12,137 +14,177 @@ entity_t EntityLookupTable::hash_double(entity_t entity) const {
 
 entity_t EntityLookupTable::get_bucket_index(entity_t entity) const {
     size_t bucket_index = hash(entity);
-    if (bucket_index < m_bucket_count_) {
+    if (bucket_index < m_split_pointer_) {
         bucket_index = hash_double(entity);
     }
     return bucket_index;
 }
 
+EntityLookupTable::Bucket*& EntityLookupTable::bucket_head(size_t bucket_index) const {
+    return m_segments_[bucket_index / BUCKET_SEGMENT_SIZE][bucket_index % BUCKET_SEGMENT_SIZE];
+}
+
+EntityLookupTable::Bucket* EntityLookupTable::find(entity_t entity) const {
+    for (Bucket* it = bucket_head(get_bucket_index(entity)); it != nullptr; it = it->next) {
+        if (it->entity == entity) {
+            return it;
+        }
+    }
+    return nullptr;
+}
+
+void EntityLookupTable::add_segment() {
+    const auto segment = static_cast<Bucket**>(m_ecs_arena_->push_zero(sizeof(Bucket*) * BUCKET_SEGMENT_SIZE));
+    m_segments_.push_back(segment);
+}
+
 EntityLookupTable::EntityLookupTable(Arena* temp_arena, Arena* ecs_arena) : EntityLookupTable(temp_arena, ecs_arena, 16) {
     
 }
 
 EntityLookupTable::EntityLookupTable(Arena* temp_arena, Arena* ecs_arena, size_t bucket_count) :
     m_temp_arena_(temp_arena),
+    m_ecs_arena_(ecs_arena),
     m_bucket_pool_(ecs_arena, 1024, sizeof(Bucket)),
-    m_buckets_(*ecs_arena, bucket_count),
+    m_segments_(*ecs_arena),
     m_size_(0),
     m_bucket_count_(bucket_count),
     m_split_pointer_(0) {
-    for (size_t i = 0; i < m_bucket_count_; i++) {
-        const auto bucket = static_cast<Bucket*>(m_bucket_pool_.allocate());
-        bucket->next = nullptr;
-        bucket->prev = nullptr;
-        bucket->entity = invalid_entity;
-        bucket->enabled_components = 0;
-        m_buckets_[i] = bucket;
+    for (size_t i = 0; i < m_bucket_count_; i += BUCKET_SEGMENT_SIZE) {
+        add_segment();
     }
 }
 
-
 size_t EntityLookupTable::get_size() const {
     return m_size_;
 }
 
-void EntityLookupTable::insert(entity_t entity, component_set enabled_components) {
-    size_t bucket = get_bucket_index(entity);
-    if (bucket >= m_bucket_count_) {
-        Bucket* new_bucket = static_cast<Bucket*>(m_bucket_pool_.allocate());
-        new_bucket->next = nullptr;
-        new_bucket->prev = nullptr;
-        new_bucket->entity = entity;
-        new_bucket->enabled_components = enabled_components;
-        m_buckets_.push_back(new_bucket);
-    } else {
-        Bucket* bucket_to_add_to = m_buckets_[bucket];
-        while (bucket_to_add_to->next != nullptr) {
-            bucket_to_add_to = bucket_to_add_to->next;
-        }
-        bucket_to_add_to->next = static_cast<Bucket*>(m_bucket_pool_.allocate());
-        Bucket* new_bucket = bucket_to_add_to->next;
-        new_bucket->entity = entity;
-        new_bucket->enabled_components = enabled_components;
-        new_bucket->prev = bucket_to_add_to;
+size_t EntityLookupTable::get_active_bucket_count() const {
+    return m_bucket_count_ + m_split_pointer_;
+}
+
+double EntityLookupTable::get_load_factor() const {
+    return static_cast<double>(m_size_) / static_cast<double>(get_active_bucket_count());
+}
+
+EntityLookupTable::Bucket* EntityLookupTable::get_bucket_head(size_t bucket_index) const {
+    return bucket_head(bucket_index);
+}
+
+void EntityLookupTable::link(entity_t entity, component_set enabled_components) {
+    Bucket*& head = bucket_head(get_bucket_index(entity));
+    Bucket* new_bucket = static_cast<Bucket*>(m_bucket_pool_.allocate());
+    new_bucket->entity = entity;
+    new_bucket->enabled_components = enabled_components;
+    new_bucket->prev = nullptr;
+    new_bucket->next = head;
+    if (head != nullptr) {
+        head->prev = new_bucket;
     }
+    head = new_bucket;
     m_size_++;
 }
 
-component_set& EntityLookupTable::get_enabled_components(entity_t entity) const {
-    size_t bucket_index = get_bucket_index(entity);
-    Bucket* bucket = m_buckets_[bucket_index];
-    for (Bucket* it = bucket; it != nullptr; ++it) {
-        if (it->entity == entity) {
-            return it->enabled_components;
-        }
+void EntityLookupTable::insert(entity_t entity, component_set enabled_components) {
+    split();
+    link(entity, enabled_components);
+}
+
+void EntityLookupTable::insert_range(EntityRange range, component_set enabled_components) {
+    const auto final_size = static_cast<double>(m_size_ + range.count);
+    const size_t budget = std::min(range.count * SPLIT_BUDGET_PER_OPERATION, SPLIT_BUDGET_PER_BULK_INSERT);
+    for (size_t i = 0; i < budget && final_size / static_cast<double>(get_active_bucket_count()) > MAX_LOAD_FACTOR; i++) {
+        split_bucket();
+    }
+    for (size_t i = 0; i < range.count; i++) {
+        link(range.first + i, enabled_components);
     }
-    // Should never reach here unless giving an expired entity
-    // Undefined behavior
+}
+
+bool EntityLookupTable::contains(entity_t entity) {
+    split();
+    return find(entity) != nullptr;
+}
+
+component_set& EntityLookupTable::get_enabled_components(entity_t entity) {
+    split();
+    Bucket* bucket = find(entity);
+    // Expired entities are undefined behavior
+    assert(bucket != nullptr && "Entity is not in the lookup table");
     return bucket->enabled_components;
 }
 
+component_set* EntityLookupTable::try_get_enabled_components(entity_t entity) {
+    split();
+    Bucket* bucket = find(entity);
+    return bucket != nullptr ? &bucket->enabled_components : nullptr;
+}
+
 void EntityLookupTable::remove(entity_t entity) {
-    const size_t bucket_index = get_bucket_index(entity);
-    Bucket* bucket = m_buckets_[bucket_index];
-    for (Bucket* it = bucket; it != nullptr; ++it) {
-        if (it->entity == entity) {
-            Bucket* prev = it->prev;
-            Bucket* next = it->next;
-            if (prev != nullptr) {
-                prev->next = next;
+    component_set removed_components;
+    remove(entity, removed_components);
+}
+
+bool EntityLookupTable::remove(entity_t entity, component_set& removed_components) {
+    Bucket* bucket = find(entity);
+    if (bucket == nullptr) {
+        return false;
+    }
+    if (bucket->prev != nullptr) {
+        bucket->prev->next = bucket->next;
+    } else {
+        bucket_head(get_bucket_index(entity)) = bucket->next;
+    }
+    if (bucket->next != nullptr) {
+        bucket->next->prev = bucket->prev;
+    }
+    removed_components = bucket->enabled_components;
+    m_bucket_pool_.deallocate(bucket);
+    m_size_--;
+    return true;
+}
+
+void EntityLookupTable::split_bucket() {
+    const size_t new_bucket_index = m_bucket_count_ + m_split_pointer_;
+    if (new_bucket_index / BUCKET_SEGMENT_SIZE >= m_segments_.size()) {
+        add_segment();
+    }
+    // Relink the nodes that rehash into the new bucket. Nothing is allocated
+    // or copied, so the cost is bounded by the length of a single chain.
+    Bucket*& old_head = bucket_head(m_split_pointer_);
+    Bucket*& new_head = bucket_head(new_bucket_index);
+    Bucket* it = old_head;
+    while (it != nullptr) {
+        Bucket* next = it->next;
+        if (hash_double(it->entity) == new_bucket_index) {
+            if (it->prev != nullptr) {
+                it->prev->next = next;
+            } else {
+                old_head = next;
             }
             if (next != nullptr) {
-                next->prev = prev;
+                next->prev = it->prev;
             }
-            if (prev == nullptr) {
-                // This is the head. Just invalidate the entity
-                it->entity = invalid_entity;
-                it->enabled_components = 0;
-            } else {
-                m_bucket_pool_.deallocate(it);
+            it->prev = nullptr;
+            it->next = new_head;
+            if (new_head != nullptr) {
+                new_head->prev = it;
             }
-            m_size_--;
-            break;
+            new_head = it;
         }
+        it = next;
+    }
+    m_split_pointer_++;
+
+    if (m_split_pointer_ >= m_bucket_count_) {
+        m_split_pointer_ = 0;
+        m_bucket_count_ *= 2;
     }
 }
 
 void EntityLookupTable::split() {
-    if (const double load_factor = static_cast<double>(m_size_) / static_cast<double>(m_bucket_count_); load_factor > 1.5) {
-        m_buckets_.push_back(static_cast<Bucket*>(m_bucket_pool_.allocate()));
-        Bucket* bucket_to_split = m_buckets_[m_split_pointer_];
-        for (Bucket* it = bucket_to_split; it != nullptr; ++it) {
-            if (it->prev != nullptr && it->prev->entity == invalid_entity) {
-                it->prev = it->prev->prev;
-                m_bucket_pool_.deallocate(it->prev);
-            }
-            entity_t new_bucket_index = hash_double(it->entity);
-            Bucket* bucket_to_add_to = m_buckets_[new_bucket_index];
-            if (bucket_to_add_to != bucket_to_split) {
-                while (bucket_to_add_to->next != nullptr) {
-                    bucket_to_add_to = bucket_to_add_to->next;
-                }
-                bucket_to_add_to->next = static_cast<Bucket*>(m_bucket_pool_.allocate());
-                Bucket* new_bucket = bucket_to_add_to->next;
-                new_bucket->entity = it->entity;
-                new_bucket->enabled_components = it->enabled_components;
-                new_bucket->prev = bucket_to_add_to;
-                new_bucket->next = nullptr;
-
-                it->entity = invalid_entity;
-                if (it->prev != nullptr) {
-                    it->prev->next = it->next;
-                }
-            }
-        }
-        m_split_pointer_++;
-
-        if (m_split_pointer_ >= m_bucket_count_) {
-            m_split_pointer_ = 0;
-            for (size_t i = 0; i < m_bucket_count_; i++) {
-                m_buckets_.push_back(static_cast<Bucket*>(m_bucket_pool_.allocate()));
-            }
-            m_bucket_count_ *= 2;
-        }
+    for (size_t i = 0; i < SPLIT_BUDGET_PER_OPERATION && get_load_factor() > MAX_LOAD_FACTOR; i++) {
+        split_bucket();
     }
 }
 
@@ -151,7 +193,7 @@ EntityLookupTable::iterator EntityLookupTable::begin() {
 }
 
 EntityLookupTable::iterator EntityLookupTable::end() {
-    return iterator{*this, m_bucket_count_};
+    return iterator{*this, get_active_bucket_count()};
 }
 
 }
\ No newline at end of file
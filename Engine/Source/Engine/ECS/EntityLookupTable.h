@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <cassert>
+#include <limits>
+
 #include "ECSTypes.h"
 #include "Containers/DynArray.h"
 #include "Memory/Arena.h"
@@ -13,6 +16,19 @@ class BucketIterator;
 constexpr size_t BUCKET_POOL_CHUNKS = 2 << 12;
 constexpr entity_t invalid_entity = std::numeric_limits<entity_t>::max();
 
+// Buckets are addressed through fixed size segments so growing the table never
+// copies or reallocates the buckets that already exist.
+constexpr size_t BUCKET_SEGMENT_SIZE = 256;
+constexpr double MAX_LOAD_FACTOR = 1.5;
+// Upper bound on the number of buckets split by a single insert or lookup.
+// Each split only rehashes one chain, so the cost of growth is spread over
+// the operations that follow instead of happening in one go.
+constexpr size_t SPLIT_BUDGET_PER_OPERATION = 2;
+// Upper bound for insert_range. A large batch can leave the table above its
+// load factor, chains are longer for a while and the operations that follow
+// split the rest within their own budget.
+constexpr size_t SPLIT_BUDGET_PER_BULK_INSERT = 256;
+
 class EntityLookupTable {
 public:
     struct Bucket {
@@ -22,33 +38,38 @@ public:
         Bucket* next;
     };
     class iterator {
-        EntityLookupTable& m_lookup_table_;
+        EntityLookupTable* m_lookup_table_;
         Bucket* m_current_bucket_;
         size_t m_index_;
+
+        void advance_to_occupied() {
+            while (m_current_bucket_ == nullptr && m_index_ < m_lookup_table_->get_active_bucket_count()) {
+                m_current_bucket_ = m_lookup_table_->get_bucket_head(m_index_);
+                if (m_current_bucket_ == nullptr) {
+                    m_index_++;
+                }
+            }
+        }
     public:
-        iterator(EntityLookupTable& lookup_table, size_t index) : m_lookup_table_(lookup_table), m_index_(index) {}
+        iterator(EntityLookupTable& lookup_table, size_t index) : m_lookup_table_(&lookup_table), m_current_bucket_(nullptr), m_index_(index) {
+            advance_to_occupied();
+        }
         
         iterator& operator++() {
-            if (m_current_bucket_ && m_current_bucket_->next) {
-                m_current_bucket_ = m_current_bucket_->next;
-            } else {
-                m_current_bucket_ = nullptr;
-                while (++m_index_ < m_lookup_table_.m_bucket_count_) {
-                    if (m_lookup_table_.m_buckets_[m_index_] != nullptr) {
-                        m_current_bucket_ = m_lookup_table_.m_buckets_[m_index_];
-                        break;
-                    }
-                }
+            m_current_bucket_ = m_current_bucket_->next;
+            if (m_current_bucket_ == nullptr) {
+                m_index_++;
+                advance_to_occupied();
             }
             return *this;
         }
 
         entity_t operator*() const {
-            return m_lookup_table_.m_buckets_[m_index_]->entity;
+            return m_current_bucket_->entity;
         }
 
         Bucket* get_bucket() const {
-            return m_lookup_table_.m_buckets_[m_index_];
+            return m_current_bucket_;
         }
 
         bool operator==(const iterator& other) const {
@@ -61,15 +82,23 @@ public:
     };
 private:
     Arena* m_temp_arena_;
+    Arena* m_ecs_arena_;
     engine::allocators::PoolAllocator m_bucket_pool_;
-    DynArray<Bucket*> m_buckets_;
+    DynArray<Bucket**> m_segments_;
     size_t m_size_;
+    // Bucket count at the start of the current round. Buckets below the split
+    // pointer have already been split and are addressed with hash_double.
     size_t m_bucket_count_;
     size_t m_split_pointer_;
 
     [[nodiscard]] entity_t hash(entity_t entity) const;
     [[nodiscard]] entity_t hash_double(entity_t entity) const;
     [[nodiscard]] entity_t get_bucket_index(entity_t entity) const;
+    [[nodiscard]] Bucket*& bucket_head(size_t bucket_index) const;
+    [[nodiscard]] Bucket* find(entity_t entity) const;
+    void add_segment();
+    void split_bucket();
+    void link(entity_t entity, component_set enabled_components);
 public:
     EntityLookupTable(Arena* temp_arena, Arena* ecs_arena);
     EntityLookupTable(Arena* temp_arena, Arena* ecs_arena, size_t bucket_count);
@@ -81,9 +110,25 @@ public:
     EntityLookupTable& operator=(EntityLookupTable&&) = delete;
 
     [[nodiscard]] size_t get_size() const;
+    [[nodiscard]] size_t get_active_bucket_count() const;
+    [[nodiscard]] double get_load_factor() const;
+    [[nodiscard]] Bucket* get_bucket_head(size_t bucket_index) const;
+
     void insert(entity_t entity, component_set enabled_components);
-    component_set& get_enabled_components(entity_t entity) const;
+    // Splits once for the whole range, up to SPLIT_BUDGET_PER_BULK_INSERT
+    // buckets, and then links every entity without per insert load checks.
+    void insert_range(EntityRange range, component_set enabled_components);
+    [[nodiscard]] bool contains(entity_t entity);
+    component_set& get_enabled_components(entity_t entity);
+    // Same as get_enabled_components but returns nullptr for expired entities
+    component_set* try_get_enabled_components(entity_t entity);
     void remove(entity_t entity);
+    // Removes the entity and hands back its components in the same lookup.
+    // Returns false if the entity was not in the table.
+    bool remove(entity_t entity, component_set& removed_components);
+    // Splits at most SPLIT_BUDGET_PER_OPERATION buckets while the table is over
+    // its load factor. Called by insert and lookups, but can also be called
+    // from idle time to get ahead of growth.
     void split();
     
     iterator begin();
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../Vendor/flecs/flecs.h"
+
+namespace ecs {
+
+// Creates count entities in a single ecs_bulk_init call, so flecs moves them
+// into their table once instead of once per set<>. Each column must point to
+// count components. If prefab is valid the entities are also made instances
+// of it. Must be called outside of progress(), flecs does not allow bulk
+// creation while the world is deferred or readonly.
+template <typename... Components>
+const flecs::entity_t* bulk_create(const flecs::world& world, int32_t count, flecs::entity prefab, const Components*... columns) {
+    ecs_bulk_desc_t desc{};
+    desc.count = count;
+
+    void* data[sizeof...(Components) + 1] = {const_cast<Components*>(columns)..., nullptr};
+    int32_t id_count = 0;
+    ((desc.ids[id_count++] = world.component<Components>().id()), ...);
+    if (prefab.is_valid()) {
+        desc.ids[id_count] = ecs_pair(EcsIsA, prefab.id());
+    }
+    desc.data = data;
+    return ecs_bulk_init(world.c_ptr(), &desc);
+}
+
+}
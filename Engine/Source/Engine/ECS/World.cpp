@@ -2,25 +2,140 @@
 
 namespace ecs {
 
-World::World(Arena& temp_arena) : m_temp_arena_(&temp_arena), m_ecs_arena_(2 << 25), m_entity_lookup_table_(&temp_arena, &m_ecs_arena_), m_new_entity_id_(0) {
+World::World(Arena& temp_arena) : m_temp_arena_(&temp_arena), m_ecs_arena_(2 << 25), m_entity_lookup_table_(&temp_arena, &m_ecs_arena_),
+    m_transforms_(m_ecs_arena_), m_renderables_(m_ecs_arena_), m_new_entity_id_(0), m_command_buffers_(m_ecs_arena_) {
     
 }
 
+World::~World() {
+    for (CommandBuffer* command_buffer : m_command_buffers_) {
+        command_buffer->~CommandBuffer();
+    }
+}
+
 entity_t World::create_entity() {
     entity_t new_entity = m_new_entity_id_++;
     m_entity_lookup_table_.insert(new_entity, 0);
     return new_entity;
 }
 
+EntityRange World::create_entities(size_t count, component_set signature) {
+    const EntityRange range = reserve_entities(count);
+    register_entities(range, signature);
+    return range;
+}
+
+EntityRange World::reserve_entities(size_t count) {
+    return {m_new_entity_id_.fetch_add(count, std::memory_order_relaxed), count};
+}
+
+void World::register_entities(EntityRange range, component_set signature) {
+    m_entity_lookup_table_.insert_range(range, signature);
+    if (signature.test(TRANSFORM_3D_COMPONENT)) {
+        m_transforms_.insert_range(range, create_transform());
+    }
+    if (signature.test(RENDERABLE_COMPONENT)) {
+        m_renderables_.insert_range(range, create_renderable(nullptr));
+    }
+}
+
 void World::destroy_entity(entity_t entity) {
-    m_entity_lookup_table_.remove(entity);
+    component_set signature;
+    if (!m_entity_lookup_table_.remove(entity, signature)) {
+        return;
+    }
+    if (signature.test(TRANSFORM_3D_COMPONENT)) {
+        m_transforms_.remove(entity);
+    }
+    if (signature.test(RENDERABLE_COMPONENT)) {
+        m_renderables_.remove(entity);
+    }
+}
+
+void World::destroy_entities(const ArrayRef<entity_t>& entities) {
+    DynArray<entity_t> transforms{*m_temp_arena_};
+    DynArray<entity_t> renderables{*m_temp_arena_};
+    for (const entity_t entity : entities) {
+        component_set signature;
+        if (!m_entity_lookup_table_.remove(entity, signature)) {
+            continue;
+        }
+        if (signature.test(TRANSFORM_3D_COMPONENT)) {
+            transforms.push_back(entity);
+        }
+        if (signature.test(RENDERABLE_COMPONENT)) {
+            renderables.push_back(entity);
+        }
+    }
+    m_transforms_.remove_batch(*m_temp_arena_, transforms.data(), transforms.size());
+    m_renderables_.remove_batch(*m_temp_arena_, renderables.data(), renderables.size());
+}
+
+CommandBuffer* World::create_command_buffer(size_t arena_size) {
+    void* memory = m_ecs_arena_.push(sizeof(CommandBuffer), alignof(CommandBuffer));
+    auto command_buffer = new (memory) CommandBuffer(this, arena_size);
+    m_command_buffers_.push_back(command_buffer);
+    return command_buffer;
+}
+
+void World::apply_add(const CommandBuffer::Command& command) {
+    switch (command.component) {
+        case TRANSFORM_3D_COMPONENT:
+            add_component(command.entities.first, *static_cast<const Transform3D*>(command.data));
+            break;
+        case RENDERABLE_COMPONENT:
+            add_component(command.entities.first, *static_cast<const Renderable*>(command.data));
+            break;
+    }
+}
+
+void World::apply_remove(const CommandBuffer::Command& command) {
+    switch (command.component) {
+        case TRANSFORM_3D_COMPONENT:
+            remove_component<Transform3D>(command.entities.first);
+            break;
+        case RENDERABLE_COMPONENT:
+            remove_component<Renderable>(command.entities.first);
+            break;
+    }
+}
+
+void World::flush_command_buffers() {
+    using CommandType = CommandBuffer::CommandType;
+    // One sweep per command type so each pass only touches the storage it needs
+    for (const CommandBuffer* command_buffer : m_command_buffers_) {
+        for (const CommandBuffer::Command& command : command_buffer->get_commands()) {
+            if (command.type == CommandType::CREATE) {
+                register_entities(command.entities, command.signature);
+            }
+        }
+    }
+    for (const CommandBuffer* command_buffer : m_command_buffers_) {
+        for (const CommandBuffer::Command& command : command_buffer->get_commands()) {
+            if (command.type == CommandType::ADD) {
+                apply_add(command);
+            } else if (command.type == CommandType::REMOVE) {
+                apply_remove(command);
+            }
+        }
+    }
+    DynArray<entity_t> destroyed{*m_temp_arena_};
+    for (CommandBuffer* command_buffer : m_command_buffers_) {
+        for (const CommandBuffer::Command& command : command_buffer->get_commands()) {
+            if (command.type == CommandType::DESTROY) {
+                destroyed.push_back(command.entities.first);
+            }
+        }
+        command_buffer->clear();
+    }
+    destroy_entities(ArrayRef{destroyed.data(), destroyed.size()});
 }
 
-Transform3D World::create_transform(entity_t entity) {
+Transform3D World::create_transform() {
     return {{0.f, 0.f, 2.5f}, {0.f, 0.f, 0.f}, {.5f, .5f, .5f}};
 }
 
-Renderable World::create_renderable(entity_t entity, engine::vulkan::VulkanModel* model) {
+Renderable World::create_renderable(engine::vulkan::VulkanModel* model) {
     return {.model = model};
 }
 
@@ -1,7 +1,13 @@
 ﻿#pragma once
 
+#include <atomic>
+
+#include "CommandBuffer.h"
+#include "ComponentPool.h"
+#include "ComponentTraits.h"
 #include "EntityLookupTable.h"
 #include "Components/Components.h"
+#include "Containers/ArrayRef.h"
 
 namespace ecs {
     using namespace components;
@@ -9,20 +15,93 @@ class World {
     Arena* m_temp_arena_;
     Arena m_ecs_arena_;
     EntityLookupTable m_entity_lookup_table_;
-    entity_t m_new_entity_id_;
+    ComponentPool<Transform3D> m_transforms_;
+    ComponentPool<Renderable> m_renderables_;
+    std::atomic<entity_t> m_new_entity_id_;
+    DynArray<CommandBuffer*> m_command_buffers_;
+
+    void register_entities(EntityRange range, component_set signature);
+    void apply_add(const CommandBuffer::Command& command);
+    void apply_remove(const CommandBuffer::Command& command);
 public:
     World(Arena& temp_arena);
-    ~World() = default;
+    ~World();
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+    World(World&&) = delete;
+    World& operator=(World&&) = delete;
 
     entity_t create_entity();
+    // Hands out count consecutive ids, registers them with one table insert and
+    // fills every component in signature with a single bulk write per pool.
+    EntityRange create_entities(size_t count, component_set signature);
     void destroy_entity(entity_t entity);
+    // Removes every entity from the table first and then each pool in one
+    // batch, ids that are not alive are skipped
+    void destroy_entities(const ArrayRef<entity_t>& entities);
+    // Thread safe. The ids are not alive until they are registered.
+    EntityRange reserve_entities(size_t count);
+
+    template <typename T>
+    void add_component(entity_t entity, const T& component);
+    template <typename T>
+    void remove_component(entity_t entity);
 
-    Transform3D create_transform(entity_t entity);
-    //Transform3D create_transform(entity_t entity, Transform3D&& transform);
-    Renderable create_renderable(entity_t entity, engine::vulkan::VulkanModel* model);
+    // Not thread safe, create one buffer per worker thread up front
+    CommandBuffer* create_command_buffer(size_t arena_size = 2 << 20);
+    // Sync point. Applies every recorded command grouped by type, creates
+    // first and destroys last, then clears the buffers.
+    void flush_command_buffers();
+
+    Transform3D create_transform();
+    //Transform3D create_transform(Transform3D&& transform);
+    Renderable create_renderable(engine::vulkan::VulkanModel* model);
+
+    template <typename T>
+    ComponentPool<T>& get_pool();
+    // Components of a range made by create_entities are contiguous, so they
+    // can be written in place. Only valid until the next structural change.
+    template <typename T>
+    T* get_components(EntityRange range);
 
     EntityLookupTable::iterator entity_iterator_begin();
     EntityLookupTable::iterator entity_iterator_end();
 };
 
+template <>
+inline ComponentPool<Transform3D>& World::get_pool<Transform3D>() {
+    return m_transforms_;
+}
+
+template <>
+inline ComponentPool<Renderable>& World::get_pool<Renderable>() {
+    return m_renderables_;
+}
+
+template <typename T>
+T* World::get_components(EntityRange range) {
+    return &get_pool<T>().get(range.first);
+}
+
+template <typename T>
+void World::add_component(entity_t entity, const T& component) {
+    component_set* signature = m_entity_lookup_table_.try_get_enabled_components(entity);
+    if (signature == nullptr) {
+        return;
+    }
+    signature->set(ComponentTraits<T>::type);
+    get_pool<T>().insert(entity, component);
+}
+
+template <typename T>
+void World::remove_component(entity_t entity) {
+    component_set* signature = m_entity_lookup_table_.try_get_enabled_components(entity);
+    if (signature == nullptr) {
+        return;
+    }
+    signature->reset(ComponentTraits<T>::type);
+    get_pool<T>().remove(entity);
+}
+
 }
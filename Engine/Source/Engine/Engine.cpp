@@ -1,16 +1,54 @@
 #include "Engine.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <new>
+#include <random>
+#include <thread>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
+#include "Profiling/Profiler.h"
 #include "Systems/CoreEngineSystems.h"
 #include "Vulkan/Camera.h"
 #include "Vulkan/VulkanRenderInfo.h"
 
+namespace {
+std::atomic<bool> log_allocations{true};
+
+void* allocate_aligned(size_t size, size_t alignment) {
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+}
+
+void free_aligned(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+}
+
 void* operator new(size_t size) {
-    std::cout << "Allocated " << std::dec << size << " bytes\n";
-    return malloc(size);
+    if (log_allocations.load(std::memory_order_relaxed)) {
+        std::cout << "Allocated " << std::dec << size << " bytes\n";
+    }
+    // Like the default, a failed allocation throws instead of handing out nullptr
+    void* p = malloc(size != 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
 }
 
 void operator delete(void* p) noexcept {
@@ -19,64 +57,313 @@ void operator delete(void* p) noexcept {
 }
 
 void* operator new[](size_t size) {
-    std::cout << "Allocated " << std::dec << size << " bytes\n";
-    return malloc(size);
+    return operator new(size);
 }
 
 void operator delete[](void* p) noexcept {
     free(p);
 }
 
+// The compiler and the standard library call the sized, aligned and nothrow
+// forms directly, left to the defaults they would mix their allocator with ours
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (log_allocations.load(std::memory_order_relaxed)) {
+        std::cout << "Allocated " << std::dec << size << " bytes\n";
+    }
+    void* p = allocate_aligned(size != 0 ? size : 1, static_cast<size_t>(alignment));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    free_aligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    free_aligned(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    free_aligned(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    free_aligned(p);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return malloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return malloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    free_aligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    free_aligned(p);
+}
+
 namespace engine {
 
+void set_allocation_logging(bool enabled) {
+    log_allocations.store(enabled, std::memory_order_relaxed);
+}
+
 constexpr int default_stack_size = 2 << 25;
+// Matches the window VulkanWrapper opens, so headless runs see the same aspect ratio
+constexpr VkExtent2D headless_extent{800, 1000};
+// Step of recordings made without a fixed delta time
+constexpr float default_record_delta_time = 1.f / 60.f;
+
+// flecs and the job system share the calling thread and split the remaining
+// cores, so the two pools never run more threads than there are cores
+static uint32_t get_job_thread_count(const EngineConfig& config) {
+    const int32_t core_count = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    return static_cast<uint32_t>(std::max(core_count - std::max(config.ecs_threads, 1) + 1, 1));
+}
 
-StealthEngine::StealthEngine() : m_temp_arena_(default_stack_size),
+StealthEngine::StealthEngine(const EngineConfig& config) : m_config_(config),
+    m_temp_arena_(default_stack_size),
      m_permanent_arena_(default_stack_size),
-    m_vulkan_wrapper_(m_temp_arena_),
-    m_renderer_(m_temp_arena_, m_permanent_arena_,
-        &m_vulkan_wrapper_.window(), m_vulkan_wrapper_.device(), m_vulkan_wrapper_.surface()),
-    m_pipeline_(m_temp_arena_, &m_renderer_, m_vulkan_wrapper_.device())
+    m_job_system_(m_permanent_arena_, get_job_thread_count(config)),
+    m_task_executor_(m_permanent_arena_, m_job_system_),
+    m_null_renderer_(headless_extent),
+    m_renderer_(&m_null_renderer_),
+    m_frame_index_(0),
+    m_frame_stats_(m_permanent_arena_, config.frame_stats_history),
+    m_random_(config.random_seed)
     {
-    
+    if (config.replay_playback_path != nullptr) {
+        if (!m_replay_.start_playback(config.replay_playback_path)) {
+            std::cerr << "Failed to read replay " << config.replay_playback_path << "\n" << std::flush;
+            throw std::runtime_error("Failed to read replay");
+        }
+        const Replay::Header& header = m_replay_.get_header();
+        if (header.fixed_delta_time <= 0.f) {
+            std::cerr << "Replay " << config.replay_playback_path << " has no fixed delta time and can't be reproduced\n" << std::flush;
+            throw std::runtime_error("Replay has no fixed delta time");
+        }
+        m_config_.random_seed = header.seed;
+        m_config_.fixed_delta_time = header.fixed_delta_time;
+        if (m_config_.frame_limit == 0 && m_config_.simulation_tick_rate <= 0.f) {
+            m_config_.frame_limit = header.tick_count;
+        }
+    }
+    if (m_config_.random_seed == 0) {
+        std::random_device device;
+        m_config_.random_seed = (static_cast<uint64_t>(device()) << 32) | device();
+    }
+    m_random_.reseed(m_config_.random_seed);
+    if (config.replay_record_path != nullptr) {
+        // Measured frame times can't be played back, so a recording always
+        // steps by a fixed delta, the tick length when there is one
+        if (m_config_.fixed_delta_time <= 0.f) {
+            m_config_.fixed_delta_time = m_config_.simulation_tick_rate > 0.f ? 1.f / m_config_.simulation_tick_rate : default_record_delta_time;
+        }
+        m_replay_.start_recording(m_config_.random_seed, m_config_.fixed_delta_time);
+    }
+
+    if (!config.headless) {
+        m_vulkan_wrapper_.emplace(m_temp_arena_);
+        m_basic_renderer_.emplace(m_temp_arena_, m_permanent_arena_,
+            &m_vulkan_wrapper_->window(), m_vulkan_wrapper_->device(), m_vulkan_wrapper_->surface());
+        m_pipeline_.emplace(m_temp_arena_, m_basic_renderer_.get(), m_vulkan_wrapper_->device(), m_config_.vertex_format);
+        m_renderer_ = m_basic_renderer_.get();
+    }
+    m_asset_loader_.emplace(m_permanent_arena_, m_task_executor_, m_job_system_, get_device(), m_renderer_->get_command_pool(),
+        m_config_.vertex_format, m_config_.max_streamed_models);
+    if (config.ecs_threads > 1) {
+        m_world_.set_threads(config.ecs_threads);
+    }
+    systems::register_components(m_world_);
+    if (config.simulation_tick_rate > 0.f) {
+        systems::register_interpolation_components(m_world_);
+    }
 }
 
 void StealthEngine::run() {
-    m_world_.add<VulkanRenderInfo>();
-    systems::setup_render_system(m_world_);
+    systems::setup_replay_system(m_world_, m_replay_);
+    systems::setup_pending_model_system(m_world_, *m_asset_loader_);
+    systems::setup_transform_system(m_world_);
+    if (m_config_.simulation_tick_rate > 0.f) {
+        run_fixed_step();
+    } else {
+        run_lockstep();
+    }
+    if (m_config_.trace_file_path != nullptr && !profiling::Profiler::write_chrome_trace(m_config_.trace_file_path)) {
+        std::cerr << "Failed to write trace to " << m_config_.trace_file_path << "\n";
+    }
+    if (m_config_.replay_record_path != nullptr && !m_replay_.write(m_config_.replay_record_path)) {
+        std::cerr << "Failed to write replay to " << m_config_.replay_record_path << "\n";
+    }
+    if (m_config_.frame_stats_file_path != nullptr && !m_frame_stats_.write_csv(m_config_.frame_stats_file_path)) {
+        std::cerr << "Failed to write frame stats to " << m_config_.frame_stats_file_path << "\n";
+    }
+}
+
+bool StealthEngine::begin_loop_iteration() {
+    if (m_config_.frame_limit > 0 && m_frame_index_ >= m_config_.frame_limit) {
+        return false;
+    }
+    m_frame_index_++;
+    if (m_config_.headless) {
+        return true;
+    }
+    m_vulkan_wrapper_->window().glfw_poll_events();
+    return !m_vulkan_wrapper_->window().should_close();
+}
+
+void StealthEngine::run_lockstep() {
+    systems::setup_draw_packet_system(m_world_);
+    const flecs::query<const components::DrawPacket> draw_packets = systems::create_draw_packet_query(m_world_);
     bool should_continue = true;
-    while (!m_vulkan_wrapper_.window().should_close() && should_continue) {
-        m_vulkan_wrapper_.window().glfw_poll_events();
+    uint64_t frame_start_ns = profiling::Profiler::now_ns();
+    while (should_continue && begin_loop_iteration()) {
+        PROFILE_ZONE("frame");
         m_temp_arena_.clear();
-        if (const auto cmd_buffer = m_renderer_.begin_frame(m_temp_arena_, m_permanent_arena_)) {
-            m_renderer_.begin_render_pass(cmd_buffer);
-            m_renderer_.bind_pipeline(m_pipeline_.get_pipeline());
-            VulkanRenderInfo* render_info = m_world_.get_mut<VulkanRenderInfo>();
-            render_info->cmd_buffer = cmd_buffer;
-            render_info->pipeline_layout = m_pipeline_.get_pipeline_layout();
-            should_continue = m_world_.progress();
-            m_renderer_.end_render_pass(cmd_buffer);
-            m_renderer_.end_frame(m_temp_arena_, m_permanent_arena_);
+        m_task_executor_.tick();
+        // Simulate and build the render list while the GPU still works on the
+        // previous frames, begin_frame is the first thing that can block
+        {
+            PROFILE_ZONE("progress");
+            should_continue = m_world_.progress(m_config_.fixed_delta_time);
+        }
+        if (const auto cmd_buffer = m_renderer_->begin_frame(m_temp_arena_, m_permanent_arena_)) {
+            record_frame(cmd_buffer, [&](const VulkanRenderInfo& render_info) {
+                systems::record_draw_packets(draw_packets, render_info);
+            });
         }
+        record_frame_stats(frame_start_ns, ecs_get_entities(m_world_.c_ptr()).alive_count);
     }
-    // Join Threads Here
+}
+
+void StealthEngine::run_fixed_step() {
+    m_simulation_.emplace(m_world_, m_config_.simulation_tick_rate, default_stack_size);
+    systems::setup_snapshot_system(m_world_, m_simulation_->get_snapshots());
+    m_simulation_->start();
+    uint64_t frame_start_ns = profiling::Profiler::now_ns();
+    // The world belongs to the simulation thread, so the count comes from its snapshots
+    int32_t entity_count = 0;
+    while (m_simulation_->should_continue() && begin_loop_iteration()) {
+        PROFILE_ZONE("frame");
+        m_temp_arena_.clear();
+        m_task_executor_.tick();
+        DynArray<components::DrawPacket> draw_packets{m_temp_arena_};
+        if (const RenderSnapshot* snapshot = m_simulation_->acquire_snapshot()) {
+            systems::build_draw_packets(*snapshot, m_simulation_->get_interpolation_alpha(*snapshot), draw_packets);
+            entity_count = snapshot->entity_count;
+        }
+        if (const auto cmd_buffer = m_renderer_->begin_frame(m_temp_arena_, m_permanent_arena_)) {
+            record_frame(cmd_buffer, [&](const VulkanRenderInfo& render_info) {
+                systems::record_draw_packets(draw_packets, render_info);
+            });
+        }
+        record_frame_stats(frame_start_ns, entity_count);
+    }
+    m_simulation_->stop();
+}
+
+void StealthEngine::record_frame_stats(uint64_t& frame_start_ns, int32_t entity_count) {
+    const uint64_t frame_end_ns = profiling::Profiler::now_ns();
+    const uint64_t frame_ns = frame_end_ns - frame_start_ns;
+    frame_start_ns = frame_end_ns;
+    const vulkan::FrameTimings timings = m_renderer_->get_frame_timings();
+    const uint64_t blocked_ns = timings.fence_wait_ns + timings.acquire_ns + timings.present_ns;
+    profiling::FrameSample sample{.frame_index = m_frame_index_, .values = {}};
+    sample.values[static_cast<size_t>(profiling::FrameMetric::FRAME_TIME)] = frame_ns;
+    sample.values[static_cast<size_t>(profiling::FrameMetric::CPU_TIME)] = frame_ns - std::min(blocked_ns, frame_ns);
+    sample.values[static_cast<size_t>(profiling::FrameMetric::FENCE_WAIT)] = timings.fence_wait_ns;
+    sample.values[static_cast<size_t>(profiling::FrameMetric::ACQUIRE)] = timings.acquire_ns;
+    sample.values[static_cast<size_t>(profiling::FrameMetric::PRESENT)] = timings.present_ns;
+    sample.values[static_cast<size_t>(profiling::FrameMetric::ENTITY_COUNT)] = static_cast<uint64_t>(entity_count);
+    m_frame_stats_.record(sample);
 }
 
 flecs::world& StealthEngine::get_world() {
     return m_world_;
 }
 
+jobs::JobSystem& StealthEngine::get_job_system() {
+    return m_job_system_;
+}
+
+tasks::TaskExecutor& StealthEngine::get_task_executor() {
+    return m_task_executor_;
+}
+
+assets::AssetLoader& StealthEngine::get_asset_loader() {
+    return *m_asset_loader_;
+}
+
+const profiling::FrameStats& StealthEngine::get_frame_stats() const {
+    return m_frame_stats_;
+}
+
+Random& StealthEngine::get_random() {
+    return m_random_;
+}
+
+Replay& StealthEngine::get_replay() {
+    return m_replay_;
+}
+
 vulkan::VulkanModel StealthEngine::create_model(
     const vulkan::VulkanModel::VertexIndexInfo& index_info) {
-    return {m_vulkan_wrapper_.device(), m_renderer_.get_command_pool(), index_info};
+    return {get_device(), m_renderer_->get_command_pool(), index_info, m_config_.vertex_format};
 }
 
 vulkan::VulkanModel StealthEngine::load_model(const char* file_name) {
-    return vulkan::VulkanModel::load_model(m_temp_arena_, m_permanent_arena_, m_vulkan_wrapper_.device(), m_renderer_.get_command_pool(), file_name);
+    return vulkan::VulkanModel::load_model(m_temp_arena_, m_permanent_arena_, get_device(), m_renderer_->get_command_pool(), file_name, &m_job_system_, m_config_.vertex_format);
+}
+
+tasks::Task<vulkan::VulkanModel*> StealthEngine::load_model_async(const char* file_name) {
+    co_return co_await m_asset_loader_->wait_for(m_asset_loader_->request_model(file_name));
 }
 
 float StealthEngine::get_aspect_ratio() const {
-    return m_renderer_.get_aspect_ratio();
+    return m_renderer_->get_aspect_ratio();
+}
+
+bool StealthEngine::is_headless() const {
+    return m_config_.headless;
+}
+
+vulkan::DeviceWrapper* StealthEngine::get_device() {
+    return m_config_.headless ? nullptr : m_vulkan_wrapper_->device();
 }
 
 ArrayRef<char> StealthEngine::read_temporary_file(Arena& temp_arena, const char* file_name) {
@@ -1,24 +1,98 @@
 #pragma once
 
 #include "Containers/ArrayRef.h"
+#include "Containers/ObjectHolder.h"
+#include "Assets/AssetLoader.h"
 #include "ECS/World.h"
+#include "Jobs/JobSystem.h"
 #include "Memory/Arena.h"
+#include "Profiling/FrameStats.h"
+#include "Replay/Random.h"
+#include "Replay/Replay.h"
+#include "Simulation/FixedStepSimulation.h"
+#include "Tasks/Task.h"
+#include "Tasks/TaskExecutor.h"
 #include "Vulkan/BasicRenderer.h"
+#include "Vulkan/NullRenderer.h"
+#include "Vulkan/Renderer.h"
 #include "Vulkan/VulkanWrapper.h"
 #include "Vulkan/Wrappers/PipelineWrapper.h"
 #include "../Vendor/flecs/flecs.h"
 #include "Vulkan/VulkanRenderInfo.h"
 
 namespace engine {
+	// Every global new is printed by default, benchmarks switch it off
+	void set_allocation_logging(bool enabled);
+
+	struct EngineConfig {
+	    // Threads flecs uses for multi_threaded systems, 1 runs everything on
+	    // the main thread. The job system gets the cores flecs leaves over.
+	    int32_t ecs_threads = 1;
+	    // Ticks per second for a simulation thread decoupled from rendering.
+	    // 0 runs the simulation once per frame on the main thread. While the
+	    // simulation thread runs, only systems may touch the world.
+	    float simulation_tick_rate = 0.f;
+	    // No window, Vulkan instance or device. Models are parsed but never
+	    // uploaded and frames record nothing, everything else runs as usual.
+	    bool headless = false;
+	    // Stops run() after this many frames, 0 runs until the window closes
+	    uint64_t frame_limit = 0;
+	    // Chrome trace of every profiled zone, written when run() returns
+	    const char* trace_file_path = nullptr;
+	    // Frames FrameStats keeps for its summaries
+	    uint32_t frame_stats_history = 4096;
+	    // Every kept frame as CSV, written when run() returns
+	    const char* frame_stats_file_path = nullptr;
+	    // Seed of the engine's Random, 0 picks one from std::random_device
+	    uint64_t random_seed = 0;
+	    // Replaces the measured frame time in the lockstep loop, 0 measures.
+	    // Fixed step ticks always advance by one tick length. Recording
+	    // replaces 0 with the tick length or 1/60.
+	    float fixed_delta_time = 0.f;
+	    // Replay log written when run() returns
+	    const char* replay_record_path = nullptr;
+	    // Replay log to play back. Its seed and delta time replace the config's
+	    // and without a frame_limit the lockstep loop stops after its ticks.
+	    const char* replay_playback_path = nullptr;
+	    // Vertex buffer layout of the pipeline and every model the engine loads
+	    vulkan::VertexFormat vertex_format = vulkan::VertexFormat::FLOAT;
+	    // Models the asset loader can stream in over the engine's lifetime
+	    uint32_t max_streamed_models = 256;
+	};
+
 	class StealthEngine {
+	    EngineConfig m_config_;
 	    Arena m_temp_arena_;
 	    Arena m_permanent_arena_;
-	    vulkan::VulkanWrapper m_vulkan_wrapper_;
-	    vulkan::BasicRenderer m_renderer_;
-	    vulkan::PipelineWrapper m_pipeline_;
+	    jobs::JobSystem m_job_system_;
+	    // Goes before the job system, its destructor waits for the
+	    // run_on_worker jobs still writing into its tasks
+	    tasks::TaskExecutor m_task_executor_;
+	    ObjectHolder<vulkan::VulkanWrapper> m_vulkan_wrapper_;
+	    ObjectHolder<vulkan::BasicRenderer> m_basic_renderer_;
+	    ObjectHolder<vulkan::PipelineWrapper> m_pipeline_;
+	    vulkan::NullRenderer m_null_renderer_;
+	    vulkan::Renderer* m_renderer_;
+	    // Destroyed after the world and before the renderer and device
+	    ObjectHolder<assets::AssetLoader> m_asset_loader_;
 	    flecs::world m_world_;
+	    ObjectHolder<FixedStepSimulation> m_simulation_;
+	    uint64_t m_frame_index_;
+	    profiling::FrameStats m_frame_stats_;
+	    Random m_random_;
+	    Replay m_replay_;
+
+	    // Polls the window and counts the frame, false once the loop should stop
+	    bool begin_loop_iteration();
+	    void run_lockstep();
+	    void run_fixed_step();
+	    // Closes the frame that started at frame_start_ns and starts the next
+	    void record_frame_stats(uint64_t& frame_start_ns, int32_t entity_count);
+	    // Record and submit stages, record is handed the frame's render info
+	    template <typename Fn>
+	    void record_frame(VkCommandBuffer cmd_buffer, Fn&& record);
 	public:
-	    StealthEngine();
+	    explicit StealthEngine(const EngineConfig& config = {});
 	    StealthEngine(const StealthEngine&) = delete;
 	    StealthEngine(StealthEngine&&) = delete;
 	    StealthEngine& operator=(const StealthEngine&) = delete;
@@ -27,11 +101,32 @@ namespace engine {
 
 	    void run();
 	    flecs::world& get_world();
+	    jobs::JobSystem& get_job_system();
+	    tasks::TaskExecutor& get_task_executor();
+	    assets::AssetLoader& get_asset_loader();
+	    const profiling::FrameStats& get_frame_stats() const;
+	    Random& get_random();
+	    Replay& get_replay();
 	    vulkan::VulkanModel create_model(const vulkan::VulkanModel::VertexIndexInfo& index_info);
 	    vulkan::VulkanModel load_model(const char* file_name);
+	    // Streams the model in through the asset loader, nullptr if it failed.
+	    // The loader owns the model. file_name has to outlive the load.
+	    tasks::Task<vulkan::VulkanModel*> load_model_async(const char* file_name);
 	    float get_aspect_ratio() const;
+	    [[nodiscard]] bool is_headless() const;
+	    // nullptr when headless
+	    vulkan::DeviceWrapper* get_device();
 
 	    static ArrayRef<char> read_temporary_file(Arena& temp_arena, const char* file_name);
 	};
 
+	template <typename Fn>
+	void StealthEngine::record_frame(VkCommandBuffer cmd_buffer, Fn&& record) {
+	    m_renderer_->begin_render_pass(cmd_buffer);
+	    m_renderer_->bind_pipeline(m_pipeline_->get_pipeline());
+	    record(VulkanRenderInfo{cmd_buffer, m_pipeline_->get_pipeline_layout()});
+	    m_renderer_->end_render_pass(cmd_buffer);
+	    m_renderer_->end_frame(m_temp_arena_, m_permanent_arena_);
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "JobSystem.h"
+
+#include <cassert>
+#include <new>
+
+namespace engine::jobs {
+
+// Set once by each pool thread, a thread only ever belongs to one pool
+static thread_local const JobSystem* current_job_system = nullptr;
+static thread_local uint32_t current_worker_index = invalid_worker_index;
+
+void JobCounter::increment(uint32_t amount) {
+    m_value_.fetch_add(amount, std::memory_order_relaxed);
+}
+
+bool JobCounter::decrement() {
+    // Sequentially consistent, so either release_held_jobs sees a job held
+    // back on this counter or try_hold_job sees the counter done
+    return m_value_.fetch_sub(1, std::memory_order_seq_cst) == 1;
+}
+
+bool JobCounter::is_done() const {
+    return m_value_.load(std::memory_order_seq_cst) == 0;
+}
+
+JobSystem::JobSystem(Arena& permanent_arena, uint32_t thread_count) : m_queued_jobs_(0), m_running_(true),
+    m_held_head_(nullptr), m_held_job_count_(0), m_external_job_count_(0), m_main_thread_id_(std::this_thread::get_id()) {
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    m_worker_count_ = thread_count;
+    m_workers_ = static_cast<Worker*>(permanent_arena.push(sizeof(Worker) * m_worker_count_, alignof(Worker)));
+    for (uint32_t i = 0; i < m_worker_count_; i++) {
+        new (&m_workers_[i]) Worker{};
+    }
+    m_external_ = static_cast<ExternalQueue*>(permanent_arena.push(sizeof(ExternalQueue), alignof(ExternalQueue)));
+    new (m_external_) ExternalQueue{};
+    for (uint32_t i = 1; i < m_worker_count_; i++) {
+        m_workers_[i].thread = std::thread(&JobSystem::worker_loop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    m_running_.store(false, std::memory_order_release);
+    m_queued_jobs_.fetch_add(1, std::memory_order_release);
+    m_queued_jobs_.notify_all();
+    for (uint32_t i = 1; i < m_worker_count_; i++) {
+        m_workers_[i].thread.join();
+    }
+    for (uint32_t i = 0; i < m_worker_count_; i++) {
+        m_workers_[i].~Worker();
+    }
+    m_external_->~ExternalQueue();
+}
+
+void JobSystem::worker_loop(uint32_t worker_index) {
+    current_job_system = this;
+    current_worker_index = worker_index;
+    while (m_running_.load(std::memory_order_acquire)) {
+        if (!try_execute_job(worker_index)) {
+            // Sleep until something is queued instead of spinning
+            m_queued_jobs_.wait(0, std::memory_order_acquire);
+        }
+    }
+}
+
+Job* JobSystem::take_job(uint32_t worker_index) {
+    if (Job* job = m_workers_[worker_index].deque.pop()) {
+        return job;
+    }
+    for (uint32_t i = 1; i < m_worker_count_; i++) {
+        const uint32_t victim = (worker_index + i) % m_worker_count_;
+        if (Job* job = m_workers_[victim].deque.steal()) {
+            return job;
+        }
+    }
+    return take_external_job();
+}
+
+Job* JobSystem::take_external_job() {
+    if (m_external_job_count_.load(std::memory_order_acquire) == 0) {
+        return nullptr;
+    }
+    std::lock_guard lock(m_external_mutex_);
+    Job* job = m_external_->head;
+    if (job == nullptr) {
+        return nullptr;
+    }
+    m_external_->head = job->next;
+    if (m_external_->head == nullptr) {
+        m_external_->tail = nullptr;
+    }
+    m_external_job_count_.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+bool JobSystem::try_execute_job(uint32_t worker_index) {
+    Job* job = take_job(worker_index);
+    if (job == nullptr) {
+        return false;
+    }
+    m_queued_jobs_.fetch_sub(1, std::memory_order_relaxed);
+    // Held back jobs only reach a deque once their dependency is done
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(Job* job) {
+    job->function(job->data);
+    JobCounter* counter = job->counter;
+    // The slot may be reused as soon as it's released, so nothing reads the job after this
+    if (job->slot_in_use != nullptr) {
+        job->slot_in_use->store(false, std::memory_order_release);
+    }
+    if (counter != nullptr && counter->decrement()) {
+        release_held_jobs();
+    }
+}
+
+void JobSystem::queue_job(Job* job) {
+    const uint32_t worker_index = get_current_worker_index();
+    if (worker_index == invalid_worker_index) {
+        queue_external_job(job);
+        return;
+    }
+    m_queued_jobs_.fetch_add(1, std::memory_order_release);
+    if (!m_workers_[worker_index].deque.push(job)) {
+        // Queue is full, doing the work here is the only way to make progress
+        m_queued_jobs_.fetch_sub(1, std::memory_order_relaxed);
+        execute(job);
+        return;
+    }
+    m_queued_jobs_.notify_one();
+}
+
+void JobSystem::queue_external_job(Job* job) {
+    job->next = nullptr;
+    {
+        std::lock_guard lock(m_external_mutex_);
+        if (m_external_->tail != nullptr) {
+            m_external_->tail->next = job;
+        } else {
+            m_external_->head = job;
+        }
+        m_external_->tail = job;
+        m_external_job_count_.fetch_add(1, std::memory_order_release);
+    }
+    m_queued_jobs_.fetch_add(1, std::memory_order_release);
+    m_queued_jobs_.notify_one();
+}
+
+bool JobSystem::try_hold_job(Job* job) {
+    std::lock_guard lock(m_held_mutex_);
+    // Counted before the dependency is checked, pairs with the order in
+    // JobCounter::decrement and release_held_jobs
+    m_held_job_count_.fetch_add(1, std::memory_order_seq_cst);
+    if (job->dependency->is_done()) {
+        m_held_job_count_.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    job->next = m_held_head_;
+    m_held_head_ = job;
+    return true;
+}
+
+void JobSystem::release_held_jobs() {
+    if (m_held_job_count_.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    Job* ready = nullptr;
+    {
+        std::lock_guard lock(m_held_mutex_);
+        Job** link = &m_held_head_;
+        while (Job* job = *link) {
+            if (job->dependency->is_done()) {
+                *link = job->next;
+                job->next = ready;
+                ready = job;
+                m_held_job_count_.fetch_sub(1, std::memory_order_relaxed);
+            } else {
+                link = &job->next;
+            }
+        }
+    }
+    while (ready != nullptr) {
+        Job* next = ready->next;
+        queue_job(ready);
+        ready = next;
+    }
+}
+
+void JobSystem::run(JobFunction function, void* data, JobCounter* counter, const JobCounter* dependency) {
+    if (counter != nullptr) {
+        counter->increment();
+    }
+    const uint32_t worker_index = get_current_worker_index();
+    Job* job;
+    if (worker_index != invalid_worker_index) {
+        Worker& worker = m_workers_[worker_index];
+        job = acquire_job_slot(worker.jobs, worker.is_job_in_use, worker.next_job, MAX_JOBS_PER_WORKER);
+    } else {
+        std::lock_guard lock(m_external_mutex_);
+        job = acquire_job_slot(m_external_->jobs, m_external_->is_job_in_use, m_external_->next_job, MAX_EXTERNAL_JOBS);
+    }
+    if (job == nullptr) {
+        // Every slot still holds an unfinished job
+        Job inline_job{function, data, counter, dependency, nullptr, nullptr};
+        if (dependency != nullptr) {
+            wait(*dependency);
+        }
+        execute(&inline_job);
+        return;
+    }
+    job->function = function;
+    job->data = data;
+    job->counter = counter;
+    job->dependency = dependency;
+    job->next = nullptr;
+    if (dependency != nullptr && try_hold_job(job)) {
+        return;
+    }
+    queue_job(job);
+}
+
+Job* JobSystem::acquire_job_slot(Job* jobs, std::atomic<bool>* is_job_in_use, uint32_t& next_job, size_t slot_count) {
+    for (size_t i = 0; i < slot_count; i++) {
+        const uint32_t slot = next_job++ % slot_count;
+        if (!is_job_in_use[slot].load(std::memory_order_acquire)) {
+            is_job_in_use[slot].store(true, std::memory_order_relaxed);
+            jobs[slot].slot_in_use = &is_job_in_use[slot];
+            return &jobs[slot];
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+    const uint32_t worker_index = get_current_worker_index();
+    while (!counter.is_done()) {
+        if (worker_index == invalid_worker_index || !try_execute_job(worker_index)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::execute_pending_job() {
+    const uint32_t worker_index = get_current_worker_index();
+    return worker_index != invalid_worker_index && try_execute_job(worker_index);
+}
+
+uint32_t JobSystem::get_thread_count() const {
+    return m_worker_count_;
+}
+
+uint32_t JobSystem::get_current_worker_index() const {
+    if (current_job_system == this) {
+        return current_worker_index;
+    }
+    return std::this_thread::get_id() == m_main_thread_id_ ? 0 : invalid_worker_index;
+}
+
+}
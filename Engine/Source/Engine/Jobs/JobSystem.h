@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "WorkStealingDeque.h"
+#include "Memory/Arena.h"
+
+namespace engine::jobs {
+
+constexpr size_t MAX_JOBS_PER_WORKER = 4096;
+constexpr size_t MAX_EXTERNAL_JOBS = 1024;
+constexpr size_t MAX_PARALLEL_FOR_BATCHES = 256;
+constexpr uint32_t invalid_worker_index = UINT32_MAX;
+
+using JobFunction = void (*)(void* data);
+
+// Tracks outstanding jobs. Every job kicked with a counter increments it and
+// decrements it once finished, so zero means all of them are done.
+class JobCounter {
+    std::atomic<uint32_t> m_value_{0};
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    void increment(uint32_t amount = 1);
+    // True if this was the last outstanding job
+    bool decrement();
+    [[nodiscard]] bool is_done() const;
+};
+
+struct Job {
+    JobFunction function;
+    void* data;
+    JobCounter* counter;
+    // Job is held back until this counter reaches zero
+    const JobCounter* dependency;
+    // Next job in the held back or external list
+    Job* next;
+    // Cleared once the job finished, nullptr for jobs run inline
+    std::atomic<bool>* slot_in_use;
+};
+
+class JobSystem {
+    struct Worker {
+        WorkStealingDeque<Job, MAX_JOBS_PER_WORKER> deque;
+        // Ring of job slots owned by this worker
+        Job jobs[MAX_JOBS_PER_WORKER];
+        // Set by run() and cleared once the job finished, wherever it ran.
+        // Stolen and held back jobs keep their slot, so run() skips busy ones.
+        std::atomic<bool> is_job_in_use[MAX_JOBS_PER_WORKER];
+        uint32_t next_job;
+        std::thread thread;
+    };
+
+    // Jobs from threads outside the pool. Any worker takes them once its own
+    // deque is empty and there is nothing to steal.
+    struct ExternalQueue {
+        Job jobs[MAX_EXTERNAL_JOBS];
+        std::atomic<bool> is_job_in_use[MAX_EXTERNAL_JOBS];
+        uint32_t next_job;
+        Job* head;
+        Job* tail;
+    };
+
+    Worker* m_workers_;
+    uint32_t m_worker_count_;
+    std::atomic<uint32_t> m_queued_jobs_;
+    std::atomic<bool> m_running_;
+    // Jobs whose dependency isn't done yet. They stay off the deques, so idle
+    // workers sleep instead of cycling them, and are queued by the worker
+    // whose job brings a counter to zero.
+    std::mutex m_held_mutex_;
+    Job* m_held_head_;
+    std::atomic<uint32_t> m_held_job_count_;
+    std::mutex m_external_mutex_;
+    ExternalQueue* m_external_;
+    std::atomic<uint32_t> m_external_job_count_;
+    // Worker 0 is found by thread id rather than a thread_local, so one
+    // thread can construct several job systems
+    std::thread::id m_main_thread_id_;
+
+    void worker_loop(uint32_t worker_index);
+    Job* take_job(uint32_t worker_index);
+    bool try_execute_job(uint32_t worker_index);
+    void execute(Job* job);
+    // Pushes a ready job on the calling worker's deque, or the external queue
+    // for threads outside the pool. Runs it inline if the deque is full.
+    void queue_job(Job* job);
+    void queue_external_job(Job* job);
+    Job* take_external_job();
+    // Next free slot in the ring, nullptr if all of them are busy
+    static Job* acquire_job_slot(Job* jobs, std::atomic<bool>* is_job_in_use, uint32_t& next_job, size_t slot_count);
+    // False if the dependency finished in the meantime and the job is ready
+    bool try_hold_job(Job* job);
+    void release_held_jobs();
+
+    template <typename Fn>
+    struct ParallelForBatch {
+        Fn* function;
+        size_t begin;
+        size_t end;
+    };
+
+    template <typename Fn>
+    static void run_parallel_for_batch(void* data);
+public:
+    // Worker 0 is the thread that constructs the job system. thread_count of 0
+    // uses one thread per hardware core.
+    JobSystem(Arena& permanent_arena, uint32_t thread_count = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    // Threads that are not part of the pool queue the job for the workers.
+    // The job runs inline only if every slot still holds an unfinished job.
+    void run(JobFunction function, void* data, JobCounter* counter, const JobCounter* dependency = nullptr);
+    // Executes other jobs while waiting instead of blocking the thread
+    void wait(const JobCounter& counter);
+    // Runs one queued job on the calling worker, false if there was none or
+    // the thread isn't part of the pool
+    bool execute_pending_job();
+    // Splits [0, count) into batches of at least min_batch_size and calls
+    // function(begin, end) for each across all workers. Returns once all are done.
+    template <typename Fn>
+    void parallel_for(size_t count, size_t min_batch_size, Fn&& function);
+
+    [[nodiscard]] uint32_t get_thread_count() const;
+    // Index of the calling thread in this pool, invalid_worker_index outside it
+    [[nodiscard]] uint32_t get_current_worker_index() const;
+};
+
+template <typename Fn>
+void JobSystem::run_parallel_for_batch(void* data) {
+    const auto batch = static_cast<ParallelForBatch<Fn>*>(data);
+    (*batch->function)(batch->begin, batch->end);
+}
+
+template <typename Fn>
+void JobSystem::parallel_for(size_t count, size_t min_batch_size, Fn&& function) {
+    using Function = std::remove_reference_t<Fn>;
+    if (count == 0) {
+        return;
+    }
+    const size_t target_batches = std::min<size_t>(static_cast<size_t>(m_worker_count_) * 4, MAX_PARALLEL_FOR_BATCHES);
+    const size_t batch_size = std::max(std::max<size_t>(min_batch_size, 1), (count + target_batches - 1) / target_batches);
+    if (batch_size >= count || m_worker_count_ == 1) {
+        function(0, count);
+        return;
+    }
+    ParallelForBatch<Function> batches[MAX_PARALLEL_FOR_BATCHES];
+    JobCounter counter;
+    size_t batch_count = 0;
+    for (size_t begin = 0; begin < count; begin += batch_size) {
+        batches[batch_count] = {&function, begin, std::min(begin + batch_size, count)};
+        run(&run_parallel_for_batch<Function>, &batches[batch_count], &counter);
+        batch_count++;
+    }
+    wait(counter);
+}
+
+}
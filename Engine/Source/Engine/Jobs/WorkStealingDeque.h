@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace engine::jobs {
+
+// Chase-Lev work stealing deque. The owning thread pushes and pops at the
+// bottom without contention, other threads steal from the top. Capacity is
+// fixed and must be a power of two, push fails instead of growing.
+template <typename T, size_t Capacity>
+class WorkStealingDeque {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+    static constexpr int64_t MASK = Capacity - 1;
+
+    alignas(64) std::atomic<int64_t> m_top_;
+    alignas(64) std::atomic<int64_t> m_bottom_;
+    alignas(64) std::atomic<T*> m_buffer_[Capacity];
+public:
+    WorkStealingDeque();
+    ~WorkStealingDeque() = default;
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+    // Owner thread only
+    bool push(T* element);
+    // Owner thread only, LIFO so the most recent (cache hot) work runs first
+    T* pop();
+    // Any thread, FIFO so thieves take the oldest and usually biggest work
+    T* steal();
+
+    [[nodiscard]] size_t size() const;
+};
+
+template <typename T, size_t Capacity>
+WorkStealingDeque<T, Capacity>::WorkStealingDeque() : m_top_(0), m_bottom_(0) {
+    for (std::atomic<T*>& element : m_buffer_) {
+        element.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, size_t Capacity>
+bool WorkStealingDeque<T, Capacity>::push(T* element) {
+    const int64_t bottom = m_bottom_.load(std::memory_order_relaxed);
+    const int64_t top = m_top_.load(std::memory_order_acquire);
+    if (bottom - top >= static_cast<int64_t>(Capacity)) {
+        return false;
+    }
+    m_buffer_[bottom & MASK].store(element, std::memory_order_relaxed);
+    // Publishes the element to thieves that acquire m_bottom_
+    m_bottom_.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T, size_t Capacity>
+T* WorkStealingDeque<T, Capacity>::pop() {
+    const int64_t bottom = m_bottom_.load(std::memory_order_relaxed) - 1;
+    m_bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+        // Already empty
+        m_bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    T* element = m_buffer_[bottom & MASK].load(std::memory_order_relaxed);
+    if (top == bottom) {
+        // Last element, race the thieves for it
+        if (!m_top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            element = nullptr;
+        }
+        m_bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return element;
+}
+
+template <typename T, size_t Capacity>
+T* WorkStealingDeque<T, Capacity>::steal() {
+    int64_t top = m_top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = m_bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return nullptr;
+    }
+    T* element = m_buffer_[top & MASK].load(std::memory_order_relaxed);
+    if (!m_top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        // Lost to the owner or another thief
+        return nullptr;
+    }
+    return element;
+}
+
+template <typename T, size_t Capacity>
+size_t WorkStealingDeque<T, Capacity>::size() const {
+    const int64_t bottom = m_bottom_.load(std::memory_order_relaxed);
+    const int64_t top = m_top_.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+}
+
+}
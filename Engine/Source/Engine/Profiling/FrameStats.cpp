@@ -0,0 +1,99 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+namespace engine::profiling {
+
+FrameStats::FrameStats(Arena& arena, uint32_t history_size) : m_capacity_(history_size), m_frame_count_(0) {
+    assert(history_size > 0 && "Frame stats need room for at least one frame");
+    m_samples_ = static_cast<FrameSample*>(arena.push(sizeof(FrameSample) * history_size, alignof(FrameSample)));
+    m_scratch_ = static_cast<uint64_t*>(arena.push(sizeof(uint64_t) * history_size, alignof(uint64_t)));
+}
+
+void FrameStats::record(const FrameSample& sample) {
+    m_samples_[m_frame_count_ % m_capacity_] = sample;
+    m_frame_count_++;
+}
+
+uint32_t FrameStats::get_sample_count() const {
+    return static_cast<uint32_t>(std::min<uint64_t>(m_frame_count_, m_capacity_));
+}
+
+uint64_t FrameStats::get_frame_count() const {
+    return m_frame_count_;
+}
+
+const FrameSample& FrameStats::get_latest() const {
+    assert(m_frame_count_ > 0 && "No frame recorded yet");
+    return m_samples_[(m_frame_count_ - 1) % m_capacity_];
+}
+
+MetricSummary FrameStats::summarize(FrameMetric metric, uint32_t window) const {
+    const uint32_t sample_count = get_sample_count();
+    if (window == 0 || window > sample_count) {
+        window = sample_count;
+    }
+    if (window == 0) {
+        return {};
+    }
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < window; i++) {
+        const uint64_t frame = m_frame_count_ - window + i;
+        m_scratch_[i] = m_samples_[frame % m_capacity_].get(metric);
+        total += m_scratch_[i];
+    }
+    std::sort(m_scratch_, m_scratch_ + window);
+    // Nearest rank, p99 of 100 frames is the slowest but one
+    const auto percentile = [&](uint32_t percent) {
+        const uint32_t rank = (window * percent + 99) / 100;
+        return m_scratch_[std::max(rank, 1u) - 1];
+    };
+    return {
+        .sample_count = window,
+        .mean = static_cast<double>(total) / window,
+        .p50 = percentile(50),
+        .p95 = percentile(95),
+        .p99 = percentile(99),
+        .max = m_scratch_[window - 1],
+    };
+}
+
+bool FrameStats::write_csv(const char* file_path) const {
+    FILE* file = fopen(file_path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "frame");
+    for (size_t metric = 0; metric < FRAME_METRIC_COUNT; metric++) {
+        fprintf(file, ",%s", get_metric_name(static_cast<FrameMetric>(metric)));
+    }
+    fprintf(file, "\n");
+    const uint32_t sample_count = get_sample_count();
+    for (uint64_t frame = m_frame_count_ - sample_count; frame < m_frame_count_; frame++) {
+        const FrameSample& sample = m_samples_[frame % m_capacity_];
+        fprintf(file, "%" PRIu64, sample.frame_index);
+        for (const uint64_t value : sample.values) {
+            fprintf(file, ",%" PRIu64, value);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+const char* FrameStats::get_metric_name(FrameMetric metric) {
+    switch (metric) {
+        case FrameMetric::FRAME_TIME: return "frame_ns";
+        case FrameMetric::CPU_TIME: return "cpu_ns";
+        case FrameMetric::FENCE_WAIT: return "fence_wait_ns";
+        case FrameMetric::ACQUIRE: return "acquire_ns";
+        case FrameMetric::PRESENT: return "present_ns";
+        case FrameMetric::ENTITY_COUNT: return "entity_count";
+        case FrameMetric::COUNT: break;
+    }
+    return "unknown";
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Memory/Arena.h"
+
+namespace engine::profiling {
+
+enum class FrameMetric : uint8_t {
+    // Start of one loop iteration to the start of the next
+    FRAME_TIME,
+    // Frame time minus fence wait, acquire and present
+    CPU_TIME,
+    FENCE_WAIT,
+    ACQUIRE,
+    PRESENT,
+    ENTITY_COUNT,
+    COUNT,
+};
+
+constexpr size_t FRAME_METRIC_COUNT = static_cast<size_t>(FrameMetric::COUNT);
+
+struct FrameSample {
+    uint64_t frame_index;
+    // Nanoseconds, entities for ENTITY_COUNT
+    uint64_t values[FRAME_METRIC_COUNT];
+
+    [[nodiscard]] uint64_t get(FrameMetric metric) const {
+        return values[static_cast<size_t>(metric)];
+    }
+};
+
+struct MetricSummary {
+    uint32_t sample_count;
+    double mean;
+    uint64_t p50;
+    uint64_t p95;
+    uint64_t p99;
+    uint64_t max;
+};
+
+// Ring of the last history_size frames. Summaries cover the newest window
+// frames, so the same history answers both the last second and the last
+// minute.
+class FrameStats {
+    FrameSample* m_samples_;
+    // Sorted copy of one metric, summarize is called rarely enough to sort
+    uint64_t* m_scratch_;
+    uint32_t m_capacity_;
+    uint64_t m_frame_count_;
+public:
+    FrameStats(Arena& arena, uint32_t history_size);
+    FrameStats(const FrameStats&) = delete;
+    FrameStats(FrameStats&&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+    FrameStats& operator=(FrameStats&&) = delete;
+    ~FrameStats() = default;
+
+    void record(const FrameSample& sample);
+    // Frames currently kept, at most history_size
+    [[nodiscard]] uint32_t get_sample_count() const;
+    [[nodiscard]] uint64_t get_frame_count() const;
+    // Newest frame, only valid once a frame was recorded
+    [[nodiscard]] const FrameSample& get_latest() const;
+    // window 0 or past the history covers every kept frame
+    [[nodiscard]] MetricSummary summarize(FrameMetric metric, uint32_t window = 0) const;
+    // One row per kept frame, oldest first
+    bool write_csv(const char* file_path) const;
+
+    static const char* get_metric_name(FrameMetric metric);
+};
+
+}
@@ -0,0 +1,89 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace engine::profiling {
+
+ThreadEventBuffer Profiler::s_buffers_[MAX_THREADS];
+std::atomic<uint32_t> Profiler::s_thread_count_{0};
+std::atomic<bool> Profiler::s_enabled_{true};
+
+namespace {
+thread_local ThreadEventBuffer* current_thread_buffer = nullptr;
+}
+
+ThreadEventBuffer* Profiler::register_thread() {
+    // Slots are never given back, threads past MAX_THREADS go unrecorded
+    const uint32_t thread_index = s_thread_count_.fetch_add(1, std::memory_order_acq_rel);
+    if (thread_index >= MAX_THREADS) {
+        return nullptr;
+    }
+    ThreadEventBuffer* buffer = &s_buffers_[thread_index];
+    buffer->thread_index = thread_index;
+    return buffer;
+}
+
+void Profiler::set_enabled(bool enabled) {
+    s_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+    ThreadEventBuffer* buffer = current_thread_buffer;
+    if (buffer == nullptr) {
+        buffer = current_thread_buffer = register_thread();
+        if (buffer == nullptr) {
+            return;
+        }
+    }
+    const uint64_t index = buffer->write_index.load(std::memory_order_relaxed);
+    buffer->events[index % ThreadEventBuffer::CAPACITY] = {name, start_ns, end_ns};
+    buffer->write_index.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::reset() {
+    const uint32_t thread_count = std::min(s_thread_count_.load(std::memory_order_acquire), MAX_THREADS);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        s_buffers_[i].write_index.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool Profiler::write_chrome_trace(const char* file_path) {
+    FILE* file = fopen(file_path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    const uint32_t thread_count = std::min(s_thread_count_.load(std::memory_order_acquire), MAX_THREADS);
+    uint64_t first_start_ns = UINT64_MAX;
+    for (uint32_t i = 0; i < thread_count; i++) {
+        const ThreadEventBuffer& buffer = s_buffers_[i];
+        const uint64_t write_index = buffer.write_index.load(std::memory_order_acquire);
+        const uint64_t count = std::min<uint64_t>(write_index, ThreadEventBuffer::CAPACITY);
+        for (uint64_t j = write_index - count; j < write_index; j++) {
+            first_start_ns = std::min(first_start_ns, buffer.events[j % ThreadEventBuffer::CAPACITY].start_ns);
+        }
+    }
+
+    // Timestamps are microseconds from the first recorded zone
+    fputs("{\"traceEvents\":[", file);
+    bool first = true;
+    for (uint32_t i = 0; i < thread_count; i++) {
+        const ThreadEventBuffer& buffer = s_buffers_[i];
+        const uint64_t write_index = buffer.write_index.load(std::memory_order_acquire);
+        const uint64_t count = std::min<uint64_t>(write_index, ThreadEventBuffer::CAPACITY);
+        for (uint64_t j = write_index - count; j < write_index; j++) {
+            const ZoneEvent& event = buffer.events[j % ThreadEventBuffer::CAPACITY];
+            fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",",
+                event.name,
+                buffer.thread_index,
+                static_cast<double>(event.start_ns - first_start_ns) / 1000.0,
+                static_cast<double>(event.end_ns - event.start_ns) / 1000.0);
+            first = false;
+        }
+    }
+    fputs("\n]}\n", file);
+    return fclose(file) == 0;
+}
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Zones compile away entirely in Dist builds
+#ifndef DIST
+#define STEALTH_PROFILING_ENABLED 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef STEALTH_PROFILING_ENABLED
+// Times the enclosing scope. name must be a string literal or otherwise
+// outlive the export.
+#define PROFILE_ZONE(name) const engine::profiling::ScopedZone PROFILE_CONCAT(profile_zone_, __LINE__){name}
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+namespace engine::profiling {
+
+struct ZoneEvent {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+// Every thread that records a zone gets one of these. Only its owner writes,
+// once full the oldest events are overwritten.
+struct ThreadEventBuffer {
+    static constexpr uint32_t CAPACITY = 1 << 14;
+
+    uint32_t thread_index;
+    std::atomic<uint64_t> write_index;
+    ZoneEvent events[CAPACITY];
+};
+
+class Profiler {
+public:
+    static constexpr uint32_t MAX_THREADS = 64;
+private:
+    static ThreadEventBuffer s_buffers_[MAX_THREADS];
+    static std::atomic<uint32_t> s_thread_count_;
+    static std::atomic<bool> s_enabled_;
+
+    static ThreadEventBuffer* register_thread();
+public:
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static bool is_enabled() {
+        return s_enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void set_enabled(bool enabled);
+    static void record(const char* name, uint64_t start_ns, uint64_t end_ns);
+    // Drops everything recorded so far
+    static void reset();
+    // Writes every buffered zone as Chrome trace event JSON, load it in
+    // chrome://tracing or Perfetto. Zones still being written by other threads
+    // may come out torn, so export after the frame loop stops.
+    static bool write_chrome_trace(const char* file_path);
+};
+
+class ScopedZone {
+    const char* m_name_;
+    uint64_t m_start_ns_;
+public:
+    explicit ScopedZone(const char* name) : m_name_(name), m_start_ns_(Profiler::is_enabled() ? Profiler::now_ns() : 0) {}
+    ~ScopedZone() {
+        if (m_start_ns_ != 0) {
+            Profiler::record(m_name_, m_start_ns_, Profiler::now_ns());
+        }
+    }
+
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+    ScopedZone(ScopedZone&&) = delete;
+    ScopedZone& operator=(ScopedZone&&) = delete;
+};
+
+}
@@ -0,0 +1,61 @@
+#include "Random.h"
+
+namespace engine {
+
+namespace {
+
+uint64_t rotate_left(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+uint64_t split_mix(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+}
+
+Random::Random(uint64_t seed) : m_state_{}, m_seed_(seed) {
+    reseed(seed);
+}
+
+void Random::reseed(uint64_t seed) {
+    m_seed_ = seed;
+    uint64_t split_mix_state = seed;
+    for (uint64_t& state : m_state_) {
+        state = split_mix(split_mix_state);
+    }
+}
+
+uint64_t Random::next_u64() {
+    const uint64_t result = rotate_left(m_state_[1] * 5, 7) * 9;
+    const uint64_t t = m_state_[1] << 17;
+    m_state_[2] ^= m_state_[0];
+    m_state_[3] ^= m_state_[1];
+    m_state_[1] ^= m_state_[2];
+    m_state_[0] ^= m_state_[3];
+    m_state_[2] ^= t;
+    m_state_[3] = rotate_left(m_state_[3], 45);
+    return result;
+}
+
+uint32_t Random::next_u32() {
+    return static_cast<uint32_t>(next_u64() >> 32);
+}
+
+float Random::next_float() {
+    // 24 bits fill the mantissa exactly, so every value is representable
+    return static_cast<float>(next_u64() >> 40) * (1.f / 16777216.f);
+}
+
+float Random::range(float min, float max) {
+    return min + (max - min) * next_float();
+}
+
+uint64_t Random::get_seed() const {
+    return m_seed_;
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace engine {
+
+// xoshiro256** seeded through splitmix64. Unlike the std distributions the
+// output doesn't depend on the standard library, so a seed gives the same
+// sequence on every platform. Not thread safe, use it from the main thread or
+// single threaded systems.
+class Random {
+    uint64_t m_state_[4];
+    uint64_t m_seed_;
+public:
+    explicit Random(uint64_t seed);
+
+    void reseed(uint64_t seed);
+    uint64_t next_u64();
+    uint32_t next_u32();
+    // [0, 1)
+    float next_float();
+    // [min, max)
+    float range(float min, float max);
+    [[nodiscard]] uint64_t get_seed() const;
+};
+
+}
@@ -0,0 +1,150 @@
+#include "Replay.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+namespace engine {
+
+namespace {
+
+constexpr char replay_magic[4] = {'S', 'R', 'P', 'L'};
+// First blocks, both arenas chain on more as the events need it
+constexpr size_t pending_arena_size = 1 << 16;
+constexpr size_t log_arena_size = 1 << 20;
+
+}
+
+Replay::Replay() : m_mode_(Mode::OFF), m_header_{}, m_pending_arena_(pending_arena_size, Arena::Growth::CHAINED), m_pending_(m_pending_arena_),
+    m_read_offset_(0), m_tick_(0), m_is_dispatching_(false), m_handlers_{} {
+}
+
+void Replay::start_recording(uint64_t seed, float fixed_delta_time) {
+    assert(m_mode_ == Mode::OFF && "Replay already started");
+    m_mode_ = Mode::RECORD;
+    memcpy(m_header_.magic, replay_magic, sizeof(replay_magic));
+    m_header_.version = VERSION;
+    m_header_.seed = seed;
+    m_header_.fixed_delta_time = fixed_delta_time;
+    m_log_arena_.emplace(log_arena_size, Arena::Growth::CHAINED);
+    m_log_.emplace(*m_log_arena_);
+}
+
+bool Replay::start_playback(const char* file_path) {
+    assert(m_mode_ == Mode::OFF && "Replay already started");
+    FILE* file = fopen(file_path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    Header header{};
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, replay_magic, sizeof(replay_magic)) != 0 ||
+        header.version != VERSION) {
+        fclose(file);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    const size_t events_size = static_cast<size_t>(ftell(file)) - sizeof(header);
+    fseek(file, sizeof(header), SEEK_SET);
+
+    // reserve rounds up to a power of two
+    m_log_arena_.emplace(events_size * 2 + 64);
+    m_log_.emplace(*m_log_arena_);
+    m_log_->push_back_n(0, events_size);
+    const bool is_read = fread(m_log_->data(), 1, events_size, file) == events_size;
+    fclose(file);
+    if (!is_read) {
+        m_log_.reset();
+        m_log_arena_.reset();
+        return false;
+    }
+    m_header_ = header;
+    m_mode_ = Mode::PLAYBACK;
+    return true;
+}
+
+bool Replay::write(const char* file_path) const {
+    assert(m_mode_ == Mode::RECORD && "Only recordings can be written");
+    FILE* file = fopen(file_path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    fwrite(&m_header_, sizeof(m_header_), 1, file);
+    fwrite(m_log_->data(), 1, m_log_->size(), file);
+    return fclose(file) == 0;
+}
+
+Replay::Mode Replay::get_mode() const {
+    return m_mode_;
+}
+
+const Replay::Header& Replay::get_header() const {
+    return m_header_;
+}
+
+uint64_t Replay::get_tick() const {
+    return m_tick_;
+}
+
+void Replay::set_handler(uint16_t type, EventHandler handler, void* context) {
+    assert(type < MAX_EVENT_TYPES && "Event type out of range");
+    m_handlers_[type] = {handler, context};
+}
+
+void Replay::submit_bytes(uint16_t type, const void* payload, uint16_t size) {
+    assert(!m_is_dispatching_ && "Event handlers can't submit events");
+    assert(type < MAX_EVENT_TYPES && "Event type out of range");
+    if (m_mode_ == Mode::PLAYBACK) {
+        return;
+    }
+    const EventRecord record{0, type, size};
+    m_pending_.push_back_range(reinterpret_cast<const uint8_t*>(&record), sizeof(record));
+    m_pending_.push_back_range(static_cast<const uint8_t*>(payload), size);
+}
+
+void Replay::dispatch(flecs::world& world, const EventRecord& record, const uint8_t* payload) {
+    // Payloads sit unaligned in the byte streams
+    alignas(16) uint8_t aligned_payload[MAX_PAYLOAD_SIZE];
+    memcpy(aligned_payload, payload, record.size);
+    const HandlerEntry& entry = m_handlers_[record.type];
+    if (entry.handler != nullptr) {
+        entry.handler(world, aligned_payload, entry.context);
+    }
+}
+
+void Replay::tick(flecs::world& world) {
+    m_is_dispatching_ = true;
+    EventRecord record{};
+    if (m_mode_ == Mode::PLAYBACK) {
+        const uint8_t* events = m_log_->data();
+        while (m_read_offset_ + sizeof(record) <= m_log_->size()) {
+            memcpy(&record, events + m_read_offset_, sizeof(record));
+            if (record.tick != m_tick_) {
+                assert(record.tick > m_tick_ && "Replay events out of order");
+                break;
+            }
+            dispatch(world, record, events + m_read_offset_ + sizeof(record));
+            m_read_offset_ += sizeof(record) + record.size;
+        }
+    } else {
+        for (size_t offset = 0; offset < m_pending_.size(); offset += sizeof(record) + record.size) {
+            memcpy(&record, m_pending_.data() + offset, sizeof(record));
+            const uint8_t* payload = m_pending_.data() + offset + sizeof(record);
+            if (m_mode_ == Mode::RECORD) {
+                record.tick = static_cast<uint32_t>(m_tick_);
+                m_log_->push_back_range(reinterpret_cast<const uint8_t*>(&record), sizeof(record));
+                m_log_->push_back_range(payload, record.size);
+                m_header_.event_count++;
+            }
+            dispatch(world, record, payload);
+        }
+        m_pending_.clear();
+        m_pending_arena_.clear();
+    }
+    m_is_dispatching_ = false;
+    m_tick_++;
+    if (m_mode_ == Mode::RECORD) {
+        m_header_.tick_count = m_tick_;
+    }
+}
+
+}
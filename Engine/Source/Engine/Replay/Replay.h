@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "Containers/DynArray.h"
+#include "Containers/ObjectHolder.h"
+#include "Memory/Arena.h"
+#include "../Vendor/flecs/flecs.h"
+
+namespace engine {
+
+// Everything that reaches the simulation from outside of it, input or spawns,
+// goes through here as an event. Submitted events are applied at the start of
+// the next tick and, when recording, written to a log with that tick. During
+// playback submitted events are dropped and the log's events are applied on
+// their ticks instead, so with the same seed and delta time the run repeats
+// exactly. Submit from the main thread or single threaded systems only.
+class Replay {
+public:
+    enum class Mode : uint8_t {
+        OFF,
+        RECORD,
+        PLAYBACK,
+    };
+
+    using EventHandler = void (*)(flecs::world& world, const void* payload, void* context);
+
+    static constexpr uint16_t MAX_EVENT_TYPES = 64;
+    static constexpr uint16_t MAX_PAYLOAD_SIZE = 256;
+    static constexpr uint32_t VERSION = 1;
+
+    // File layout is the header followed by header.event_count events, each
+    // an EventRecord and its payload. Everything is little endian.
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t seed;
+        uint64_t tick_count;
+        float fixed_delta_time;
+        uint32_t event_count;
+    };
+
+    struct EventRecord {
+        uint32_t tick;
+        uint16_t type;
+        uint16_t size;
+    };
+private:
+    struct HandlerEntry {
+        EventHandler handler;
+        void* context;
+    };
+
+    Mode m_mode_;
+    Header m_header_;
+    Arena m_pending_arena_;
+    DynArray<uint8_t> m_pending_;
+    ObjectHolder<Arena> m_log_arena_;
+    ObjectHolder<DynArray<uint8_t>> m_log_;
+    size_t m_read_offset_;
+    uint64_t m_tick_;
+    bool m_is_dispatching_;
+    HandlerEntry m_handlers_[MAX_EVENT_TYPES];
+
+    void submit_bytes(uint16_t type, const void* payload, uint16_t size);
+    void dispatch(flecs::world& world, const EventRecord& record, const uint8_t* payload);
+public:
+    Replay();
+    Replay(const Replay&) = delete;
+    Replay(Replay&&) = delete;
+    Replay& operator=(const Replay&) = delete;
+    Replay& operator=(Replay&&) = delete;
+    ~Replay() = default;
+
+    void start_recording(uint64_t seed, float fixed_delta_time);
+    // False if the file is missing or not a replay. The run has to use the
+    // header's seed and delta time to reproduce the recording.
+    bool start_playback(const char* file_path);
+    // Writes the events recorded so far
+    bool write(const char* file_path) const;
+
+    [[nodiscard]] Mode get_mode() const;
+    [[nodiscard]] const Header& get_header() const;
+    [[nodiscard]] uint64_t get_tick() const;
+
+    // Handlers run at the start of a tick with the world out of deferred mode,
+    // they may not submit events themselves
+    void set_handler(uint16_t type, EventHandler handler, void* context = nullptr);
+
+    template <typename T>
+    void submit(uint16_t type, const T& payload);
+
+    // Applies this tick's events, the replay system calls it once per tick
+    void tick(flecs::world& world);
+};
+
+template <typename T>
+void Replay::submit(uint16_t type, const T& payload) {
+    static_assert(std::is_trivially_copyable_v<T>, "Replay payloads are stored as raw bytes");
+    static_assert(sizeof(T) <= MAX_PAYLOAD_SIZE, "Replay payload too large");
+    static_assert(alignof(T) <= 16, "Replay payloads are handed out 16 byte aligned");
+    submit_bytes(type, &payload, static_cast<uint16_t>(sizeof(T)));
+}
+
+}
@@ -0,0 +1,88 @@
+#include "FixedStepSimulation.h"
+
+#include <algorithm>
+
+#include "Engine/Profiling/Profiler.h"
+namespace engine {
+
+FixedStepSimulation::FixedStepSimulation(flecs::world& world, float tick_rate, size_t snapshot_arena_size) :
+    m_world_(&world),
+    m_tick_length_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(1.f / tick_rate))),
+    m_tick_seconds_(1.f / tick_rate),
+    m_snapshots_(snapshot_arena_size),
+    m_has_snapshot_(false),
+    m_running_(false),
+    m_world_quit_(false) {
+    assert(tick_rate > 0.f && "Tick rate must be positive");
+}
+
+FixedStepSimulation::~FixedStepSimulation() {
+    stop();
+}
+
+void FixedStepSimulation::start() {
+    assert(!m_running_.load() && "Simulation already running");
+    m_running_.store(true, std::memory_order_release);
+    m_thread_ = std::thread(&FixedStepSimulation::simulation_loop, this);
+}
+
+void FixedStepSimulation::stop() {
+    m_running_.store(false, std::memory_order_release);
+    if (m_thread_.joinable()) {
+        m_thread_.join();
+    }
+}
+
+void FixedStepSimulation::simulation_loop() {
+    using clock = std::chrono::steady_clock;
+    clock::time_point next_tick = clock::now();
+    while (m_running_.load(std::memory_order_acquire)) {
+        const clock::time_point now = clock::now();
+        if (now < next_tick) {
+            std::this_thread::sleep_until(next_tick);
+            continue;
+        }
+        // Slower than real time, catching up on everything would only make
+        // the next tick later still
+        if (now - next_tick > m_tick_length_ * MAX_CATCH_UP_TICKS) {
+            next_tick = now;
+        }
+
+        PROFILE_ZONE("simulation_tick");
+        RenderSnapshot& snapshot = m_snapshots_.get_back();
+        snapshot.clear();
+        const bool should_continue = m_world_->progress(m_tick_seconds_);
+        snapshot.tick_time = next_tick;
+        m_snapshots_.publish();
+        next_tick += m_tick_length_;
+
+        if (!should_continue) {
+            m_world_quit_.store(true, std::memory_order_release);
+            break;
+        }
+    }
+}
+
+bool FixedStepSimulation::should_continue() const {
+    return !m_world_quit_.load(std::memory_order_acquire);
+}
+
+TripleBuffer<RenderSnapshot>& FixedStepSimulation::get_snapshots() {
+    return m_snapshots_;
+}
+
+const RenderSnapshot* FixedStepSimulation::acquire_snapshot() {
+    if (m_snapshots_.acquire()) {
+        m_has_snapshot_ = true;
+    }
+    return m_has_snapshot_ ? &m_snapshots_.get_front() : nullptr;
+}
+
+float FixedStepSimulation::get_interpolation_alpha(const RenderSnapshot& snapshot) const {
+    // Drawing one tick behind the simulation means there is always a pose on
+    // either side of the frame to blend between
+    const std::chrono::duration<float> since_tick = std::chrono::steady_clock::now() - snapshot.tick_time;
+    return std::clamp(since_tick.count() / m_tick_seconds_, 0.f, 1.f);
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "RenderSnapshot.h"
+#include "Containers/TripleBuffer.h"
+#include "../Vendor/flecs/flecs.h"
+
+namespace engine {
+
+// Runs world.progress at a fixed rate on its own thread. Every tick publishes
+// a RenderSnapshot, which the render thread interpolates between so frame
+// rate and tick rate don't have to match. While it runs the world belongs to
+// the simulation thread.
+class FixedStepSimulation {
+public:
+    // Ticks a late simulation runs back to back before it drops the backlog
+    static constexpr uint32_t MAX_CATCH_UP_TICKS = 5;
+private:
+    flecs::world* m_world_;
+    std::chrono::steady_clock::duration m_tick_length_;
+    float m_tick_seconds_;
+    TripleBuffer<RenderSnapshot> m_snapshots_;
+    bool m_has_snapshot_;
+    std::atomic<bool> m_running_;
+    std::atomic<bool> m_world_quit_;
+    std::thread m_thread_;
+
+    void simulation_loop();
+public:
+    FixedStepSimulation(flecs::world& world, float tick_rate, size_t snapshot_arena_size);
+    ~FixedStepSimulation();
+
+    FixedStepSimulation(const FixedStepSimulation&) = delete;
+    FixedStepSimulation& operator=(const FixedStepSimulation&) = delete;
+    FixedStepSimulation(FixedStepSimulation&&) = delete;
+    FixedStepSimulation& operator=(FixedStepSimulation&&) = delete;
+
+    void start();
+    // Joins the simulation thread, the world is safe to use again afterwards
+    void stop();
+    // False once a system called world.quit()
+    [[nodiscard]] bool should_continue() const;
+
+    TripleBuffer<RenderSnapshot>& get_snapshots();
+    // Newest published snapshot, nullptr until the first tick finished
+    const RenderSnapshot* acquire_snapshot();
+    // How far between the snapshot's previous and current pose to draw
+    [[nodiscard]] float get_interpolation_alpha(const RenderSnapshot& snapshot) const;
+};
+
+}
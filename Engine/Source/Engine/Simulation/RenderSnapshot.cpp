@@ -0,0 +1,14 @@
+#include "RenderSnapshot.h"
+
+namespace engine {
+
+RenderSnapshot::RenderSnapshot(size_t arena_size) : arena(arena_size), entries(arena) {
+    
+}
+
+void RenderSnapshot::clear() {
+    entries.clear();
+    arena.clear();
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+
+#include <glm/glm.hpp>
+
+#include "Containers/DynArray.h"
+#include "Engine/ECS/Components/Components.h"
+#include "Memory/Arena.h"
+
+namespace engine {
+
+// What the render thread needs from one simulation tick. Each entry carries
+// the pose from the tick before as well, so the render thread can interpolate
+// without looking anything up.
+struct RenderSnapshot {
+    struct Entry {
+        vulkan::VulkanModel* model;
+        components::WorldPose previous;
+        components::WorldPose current;
+    };
+
+    Arena arena;
+    DynArray<Entry> entries;
+    glm::mat4 projection{1.f};
+    float lod_threshold = 0.f;
+    std::chrono::steady_clock::time_point tick_time;
+    // Alive entities when the tick finished, for the frame stats
+    int32_t entity_count = 0;
+
+    explicit RenderSnapshot(size_t arena_size);
+    void clear();
+};
+
+}
@@ -1,19 +1,192 @@
 ﻿#include "CoreEngineSystems.h"
 
+#include "Engine/Profiling/Profiler.h"
+
 namespace systems {
 
-void setup_render_system(const flecs::world& world) {
-    world.system<components::Transform3D, components::Renderable>()
+void register_components(const flecs::world& world) {
+    // Every entity with a transform gets a cached world matrix. Traits have to
+    // be set before the component is used, so this runs before the game spawns.
+    world.component<components::Transform3D>().add(flecs::With, world.component<components::WorldMatrix>());
+    world.component<components::Renderable>().add(flecs::With, world.component<components::DrawPacket>());
+}
+
+void register_interpolation_components(const flecs::world& world) {
+    world.component<components::Renderable>().add(flecs::With, world.component<components::InterpolatedPose>());
+}
+
+void setup_replay_system(const flecs::world& world, engine::Replay& replay) {
+    engine::Replay* target = &replay;
+    // Immediate so entities spawned by events exist for the rest of the tick
+    world.system()
+        .kind(flecs::OnLoad)
+        .immediate()
+        .run([target](flecs::iter& it) {
+            flecs::world tick_world = it.world();
+            target->tick(tick_world);
+        });
+}
+
+void setup_pending_model_system(const flecs::world& world, const engine::assets::AssetLoader& asset_loader) {
+    const engine::assets::AssetLoader* loader = &asset_loader;
+    world.system<components::Renderable, const components::PendingModel>()
+        .query_flags(EcsQueryMatchPrefab)
+        .kind(flecs::PreUpdate)
+        .each([loader](flecs::entity entity, components::Renderable& renderable, const components::PendingModel& pending) {
+            if (!loader->is_done(pending.handle)) {
+                return;
+            }
+            // Failed loads keep the placeholder
+            renderable.model = loader->get_model(pending.handle);
+            entity.remove<components::PendingModel>();
+        });
+}
+
+void setup_transform_system(const flecs::world& world) {
+    // Transform3D is relative to the ChildOf parent. Cascade yields tables in
+    // breadth first depth order, so a parent's world matrix is always final
+    // before its children read it and the whole hierarchy updates in one pass.
+    // Stays single threaded, worker threads would split a parent table and
+    // its children across stages with no ordering between them.
+    world.system<const components::Transform3D, components::WorldMatrix, const components::WorldMatrix*>()
+        .term_at(2).cascade(flecs::ChildOf)
+        .kind(flecs::PostUpdate)
+        .run([](flecs::iter& it) {
+            PROFILE_ZONE("transform_system");
+            while (it.next()) {
+                // Tables whose transforms and parent matrix were not written
+                // since the last run keep their matrices, which skips clean
+                // subtrees. skip() keeps them from being marked dirty.
+                if (!it.changed()) {
+                    it.skip();
+                    continue;
+                }
+                const auto transforms = it.field<const components::Transform3D>(0);
+                const auto world_matrices = it.field<components::WorldMatrix>(1);
+                if (it.is_set(2)) {
+                    const glm::mat4 parent_matrix = it.field<const components::WorldMatrix>(2)->matrix;
+                    for (const size_t i : it) {
+                        world_matrices[i].matrix = parent_matrix * transforms[i].as_matrix();
+                    }
+                } else {
+                    for (const size_t i : it) {
+                        world_matrices[i].matrix = transforms[i].as_matrix();
+                    }
+                }
+            }
+        });
+}
+
+void setup_draw_packet_system(const flecs::world& world) {
+    world.system<const components::WorldMatrix, const components::Renderable, components::DrawPacket>()
         .kind(flecs::PostUpdate)
-        .each([](flecs::entity entity, components::Transform3D& transform, components::Renderable& renderable) {
-            const flecs::world ecs_world = entity.world();
-            const auto& [cmd_buffer, pipeline_layout] = *ecs_world.get<VulkanRenderInfo>();
-            const Camera* camera = ecs_world.get<Camera>();
-            const PushConstantStruct push_constant{.transform = camera->get_projection() * transform.as_matrix()};
-            vkCmdPushConstants(cmd_buffer, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantStruct), &push_constant);
-            renderable.model->bind(cmd_buffer);
-            renderable.model->draw(cmd_buffer);  
+        .multi_threaded()
+        .run([](flecs::iter& it) {
+            PROFILE_ZONE("draw_packet_system");
+            // Singletons are read once per run instead of once per entity
+            const Camera* camera = it.world().get<Camera>();
+            const glm::mat4 projection = camera->get_projection();
+            const float lod_threshold = camera->get_lod_threshold();
+            while (it.next()) {
+                const auto world_matrices = it.field<const components::WorldMatrix>(0);
+                const auto renderables = it.field<const components::Renderable>(1);
+                const auto draw_packets = it.field<components::DrawPacket>(2);
+                for (const size_t i : it) {
+                    draw_packets[i].transform = projection * world_matrices[i].matrix;
+                    const engine::vulkan::VulkanModel* model = renderables[i].model;
+                    draw_packets[i].model = renderables[i].model;
+                    // Renderables without a model yet draw nothing, LOD 0 keeps the packet valid
+                    draw_packets[i].lod = model != nullptr ? model->select_lod(draw_packets[i].transform, lod_threshold) : 0;
+                }
+            }
         });
 }
 
+flecs::query<const components::DrawPacket> create_draw_packet_query(const flecs::world& world) {
+    return world.query_builder<const components::DrawPacket>()
+        .cached()
+        .build();
+}
+
+namespace {
+
+void record_draw_packet(const VulkanRenderInfo& render_info, const components::DrawPacket& packet, const engine::vulkan::VulkanModel*& bound_model) {
+    // Quantized positions are fractions of the model's bounds
+    const bool is_quantized = packet.model->get_vertex_format() != engine::vulkan::VertexFormat::FLOAT;
+    const PushConstantStruct push_constant{.transform = is_quantized ? packet.transform * packet.model->get_position_transform() : packet.transform};
+    vkCmdPushConstants(render_info.cmd_buffer, render_info.pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PushConstantStruct), &push_constant);
+    // Instances of the same prefab are next to each other, so rebinding only
+    // when the model changes skips most binds
+    if (packet.model != bound_model) {
+        packet.model->bind(render_info.cmd_buffer);
+        bound_model = packet.model;
+    }
+    packet.model->draw(render_info.cmd_buffer, packet.lod);
+}
+
+}
+
+void record_draw_packets(const flecs::query<const components::DrawPacket>& draw_packets, const VulkanRenderInfo& render_info) {
+    PROFILE_ZONE("record_draw_packets");
+    const engine::vulkan::VulkanModel* bound_model = nullptr;
+    draw_packets.run([&](flecs::iter& it) {
+        while (it.next()) {
+            const auto packets = it.field<const components::DrawPacket>(0);
+            for (const size_t i : it) {
+                record_draw_packet(render_info, packets[i], bound_model);
+            }
+        }
+    });
+}
+
+void record_draw_packets(const DynArray<components::DrawPacket>& draw_packets, const VulkanRenderInfo& render_info) {
+    PROFILE_ZONE("record_draw_packets");
+    const engine::vulkan::VulkanModel* bound_model = nullptr;
+    for (const components::DrawPacket& packet : draw_packets) {
+        record_draw_packet(render_info, packet, bound_model);
+    }
+}
+
+void setup_snapshot_system(const flecs::world& world, TripleBuffer<engine::RenderSnapshot>& snapshots) {
+    TripleBuffer<engine::RenderSnapshot>* target = &snapshots;
+    // Runs after the transform system so the world matrices are final
+    world.system<const components::WorldMatrix, const components::Renderable, components::InterpolatedPose>()
+        .kind(flecs::OnStore)
+        .run([target](flecs::iter& it) {
+            PROFILE_ZONE("snapshot_system");
+            engine::RenderSnapshot& snapshot = target->get_back();
+            const Camera* camera = it.world().get<Camera>();
+            snapshot.projection = camera->get_projection();
+            snapshot.lod_threshold = camera->get_lod_threshold();
+            snapshot.entity_count = ecs_get_entities(it.world().c_ptr()).alive_count;
+            while (it.next()) {
+                const auto world_matrices = it.field<const components::WorldMatrix>(0);
+                const auto renderables = it.field<const components::Renderable>(1);
+                const auto poses = it.field<components::InterpolatedPose>(2);
+                for (const size_t i : it) {
+                    components::InterpolatedPose& pose = poses[i];
+                    pose.current = components::WorldPose::from_matrix(world_matrices[i].matrix);
+                    // Entities spawned this tick have nothing to blend from
+                    if (!pose.has_previous) {
+                        pose.previous = pose.current;
+                        pose.has_previous = true;
+                    }
+                    snapshot.entries.push_back({renderables[i].model, pose.previous, pose.current});
+                    pose.previous = pose.current;
+                }
+            }
+        });
+}
+
+void build_draw_packets(const engine::RenderSnapshot& snapshot, float alpha, DynArray<components::DrawPacket>& draw_packets) {
+    PROFILE_ZONE("build_draw_packets");
+    draw_packets.reserve(snapshot.entries.size());
+    for (const engine::RenderSnapshot::Entry& entry : snapshot.entries) {
+        const glm::mat4 world_matrix = components::WorldPose::interpolate(entry.previous, entry.current, alpha).as_matrix();
+        const glm::mat4 transform = snapshot.projection * world_matrix;
+        const uint32_t lod = entry.model != nullptr ? entry.model->select_lod(transform, snapshot.lod_threshold) : 0;
+        draw_packets.push_back({transform, entry.model, lod});
+    }
+}
+
 }
\ No newline at end of file
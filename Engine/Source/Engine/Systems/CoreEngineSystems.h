@@ -3,7 +3,12 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include "Containers/DynArray.h"
+#include "Containers/TripleBuffer.h"
+#include "Engine/Assets/AssetLoader.h"
 #include "Engine/ECS/Components/Components.h"
+#include "Engine/Replay/Replay.h"
+#include "Engine/Simulation/RenderSnapshot.h"
 #include "Engine/Vulkan/Camera.h"
 #include "Engine/Vulkan/VulkanRenderInfo.h"
 #include "../Vendor/flecs/flecs.h"
@@ -14,6 +19,25 @@ struct PushConstantStruct {
     glm::mat4 transform;
 };
 
-void setup_render_system(const flecs::world& world);
+void register_components(const flecs::world& world);
+// Only for the fixed step mode, gives renderables an InterpolatedPose
+void register_interpolation_components(const flecs::world& world);
+void setup_transform_system(const flecs::world& world);
+// Applies the tick's replay events before any other system runs
+void setup_replay_system(const flecs::world& world, engine::Replay& replay);
+// Points renderables at their streamed model once it's ready, prefabs included
+void setup_pending_model_system(const flecs::world& world, const engine::assets::AssetLoader& asset_loader);
+// Runs on the flecs worker threads, writes one DrawPacket per renderable
+void setup_draw_packet_system(const flecs::world& world);
+// Record stage. Runs after progress() and begin_frame, outside of the world's
+// pipeline, so simulation never has to wait on a frame fence.
+flecs::query<const components::DrawPacket> create_draw_packet_query(const flecs::world& world);
+void record_draw_packets(const flecs::query<const components::DrawPacket>& draw_packets, const VulkanRenderInfo& render_info);
+void record_draw_packets(const DynArray<components::DrawPacket>& draw_packets, const VulkanRenderInfo& render_info);
+// Fixed step replacement for the draw packet and render systems. Writes every
+// renderable's pose into the simulation's back snapshot each tick.
+void setup_snapshot_system(const flecs::world& world, TripleBuffer<engine::RenderSnapshot>& snapshots);
+// Builds the render list for a snapshot on the render thread, blending poses by alpha
+void build_draw_packets(const engine::RenderSnapshot& snapshot, float alpha, DynArray<components::DrawPacket>& draw_packets);
 
 }
\ No newline at end of file
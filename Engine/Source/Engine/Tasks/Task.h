@@ -0,0 +1,162 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "Containers/ObjectHolder.h"
+
+namespace engine::tasks {
+
+template <typename T>
+class Task;
+
+// Shared by every task promise. Resumes whoever awaited the task once it
+// finishes, and holds on to an exception until the awaiter can rethrow it.
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            if (const std::coroutine_handle<> continuation = handle.promise().continuation) {
+                return continuation;
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // Tasks are lazy, nothing runs until the task is awaited or spawned
+    std::suspend_always initial_suspend() const noexcept {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept {
+        return {};
+    }
+
+    void unhandled_exception() noexcept {
+        exception = std::current_exception();
+    }
+
+    void rethrow_if_failed() const {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    ObjectHolder<T> result;
+
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& value) {
+        result.emplace(std::forward<U>(value));
+    }
+
+    T take_result() {
+        rethrow_if_failed();
+        return std::move(*result);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() const noexcept {}
+
+    void take_result() const {
+        rethrow_if_failed();
+    }
+};
+
+// Coroutine that can suspend across frames. Awaiting a task starts it and
+// resumes the awaiter with its result when it finishes. Top level tasks are
+// handed to TaskExecutor::spawn.
+template <typename T = void>
+class Task {
+public:
+    using promise_type = TaskPromise<T>;
+private:
+    std::coroutine_handle<promise_type> m_handle_;
+public:
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle_(handle) {}
+    ~Task();
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& other) noexcept;
+    Task& operator=(Task&& other) noexcept;
+
+    bool await_ready() const noexcept {
+        return !m_handle_ || m_handle_.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        m_handle_.promise().continuation = awaiting;
+        return m_handle_;
+    }
+
+    T await_resume() {
+        return m_handle_.promise().take_result();
+    }
+
+    [[nodiscard]] bool is_done() const;
+    // Gives up ownership of the coroutine frame, used by the executor
+    std::coroutine_handle<promise_type> release();
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+}
+
+template <typename T>
+Task<T>::~Task() {
+    if (m_handle_) {
+        m_handle_.destroy();
+    }
+}
+
+template <typename T>
+Task<T>::Task(Task&& other) noexcept : m_handle_(std::exchange(other.m_handle_, nullptr)) {
+    
+}
+
+template <typename T>
+Task<T>& Task<T>::operator=(Task&& other) noexcept {
+    if (this != &other) {
+        if (m_handle_) {
+            m_handle_.destroy();
+        }
+        m_handle_ = std::exchange(other.m_handle_, nullptr);
+    }
+    return *this;
+}
+
+template <typename T>
+bool Task<T>::is_done() const {
+    return !m_handle_ || m_handle_.done();
+}
+
+template <typename T>
+std::coroutine_handle<typename Task<T>::promise_type> Task<T>::release() {
+    return std::exchange(m_handle_, nullptr);
+}
+
+}
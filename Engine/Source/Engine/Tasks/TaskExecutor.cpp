@@ -0,0 +1,95 @@
+#include "TaskExecutor.h"
+
+#include "Engine/Profiling/Profiler.h"
+
+namespace engine::tasks {
+
+TaskExecutor::TaskExecutor(Arena& permanent_arena, jobs::JobSystem& job_system) : m_job_system_(&job_system),
+    m_root_tasks_(permanent_arena), m_scheduled_head_(nullptr), m_polled_head_(nullptr) {
+    
+}
+
+TaskExecutor::~TaskExecutor() {
+    m_job_system_->wait(m_worker_counter_);
+    for (const std::coroutine_handle<TaskPromise<void>> handle : m_root_tasks_) {
+        handle.destroy();
+    }
+}
+
+void TaskExecutor::spawn(Task<void>&& task) {
+    const std::coroutine_handle<TaskPromise<void>> handle = task.release();
+    m_root_tasks_.push_back(handle);
+    // Runs until the first suspension point, tick() frees it once it's done
+    handle.resume();
+}
+
+void TaskExecutor::schedule(ScheduledNode* node) {
+    ScheduledNode* head = m_scheduled_head_.load(std::memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!m_scheduled_head_.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void TaskExecutor::tick() {
+    PROFILE_ZONE("task_tick");
+    // With a single thread there is no worker to pick up run_on_worker jobs,
+    // so the frame has to do them itself
+    if (m_job_system_->get_thread_count() == 1) {
+        while (m_job_system_->execute_pending_job()) {
+        }
+    }
+
+    // Only resume what was ready before this tick started, anything scheduled
+    // while resuming waits for the next one
+    ScheduledNode* scheduled = m_scheduled_head_.exchange(nullptr, std::memory_order_acquire);
+    ScheduledNode* ordered = nullptr;
+    while (scheduled != nullptr) {
+        ScheduledNode* next = scheduled->next;
+        scheduled->next = ordered;
+        ordered = scheduled;
+        scheduled = next;
+    }
+    while (ordered != nullptr) {
+        ScheduledNode* next = ordered->next;
+        ordered->handle.resume();
+        ordered = next;
+    }
+
+    PollNode* polled = m_polled_head_;
+    m_polled_head_ = nullptr;
+    while (polled != nullptr) {
+        PollNode* next = polled->next;
+        if (polled->poll(polled->awaiter)) {
+            polled->handle.resume();
+        } else {
+            polled->next = m_polled_head_;
+            m_polled_head_ = polled;
+        }
+        polled = next;
+    }
+
+    for (size_t i = 0; i < m_root_tasks_.size();) {
+        std::coroutine_handle<TaskPromise<void>> handle = m_root_tasks_[i];
+        if (!handle.done()) {
+            i++;
+            continue;
+        }
+        m_root_tasks_[i] = m_root_tasks_[m_root_tasks_.size() - 1];
+        m_root_tasks_.pop_back();
+        const std::exception_ptr exception = handle.promise().exception;
+        handle.destroy();
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+size_t TaskExecutor::get_task_count() const {
+    return m_root_tasks_.size();
+}
+
+TaskExecutor::NextFrameAwaiter TaskExecutor::next_frame() {
+    return {this, {}};
+}
+
+}
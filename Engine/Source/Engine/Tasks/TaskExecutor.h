@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <coroutine>
+#include <type_traits>
+
+#include "Task.h"
+#include "Containers/DynArray.h"
+#include "Containers/ObjectHolder.h"
+#include "Engine/Jobs/JobSystem.h"
+#include "Memory/Arena.h"
+
+namespace engine::tasks {
+
+// Drives tasks from the frame loop. Tasks only ever resume on the thread
+// that calls tick(), so they can touch the renderer freely and push anything
+// slow to a worker with run_on_worker. They must not touch the world while a
+// FixedStepSimulation runs, it belongs to the simulation thread then.
+class TaskExecutor {
+public:
+    // Intrusive queue links. They live inside the awaiter, which lives in the
+    // suspended coroutine frame, so scheduling never allocates.
+    struct ScheduledNode {
+        std::coroutine_handle<> handle;
+        ScheduledNode* next;
+    };
+
+    struct PollNode {
+        std::coroutine_handle<> handle;
+        PollNode* next;
+        void* awaiter;
+        bool (*poll)(void* awaiter);
+    };
+private:
+    jobs::JobSystem* m_job_system_;
+    DynArray<std::coroutine_handle<TaskPromise<void>>> m_root_tasks_;
+    std::atomic<ScheduledNode*> m_scheduled_head_;
+    PollNode* m_polled_head_;
+    // run_on_worker jobs still writing into task frames, the destructor
+    // waits for them before it frees the frames
+    jobs::JobCounter m_worker_counter_;
+
+    struct NextFrameAwaiter {
+        TaskExecutor* executor;
+        ScheduledNode node;
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            node.handle = handle;
+            executor->schedule(&node);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    template <typename Fn>
+    struct WorkerAwaiter {
+        using Result = std::invoke_result_t<Fn&>;
+        using Storage = std::conditional_t<std::is_void_v<Result>, bool, Result>;
+
+        TaskExecutor* executor;
+        Fn function;
+        ScheduledNode node;
+        ObjectHolder<Storage> result;
+
+        static void run(void* data) {
+            auto self = static_cast<WorkerAwaiter*>(data);
+            if constexpr (std::is_void_v<Result>) {
+                self->function();
+            } else {
+                self->result.emplace(self->function());
+            }
+            self->executor->schedule(&self->node);
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            node.handle = handle;
+            executor->m_job_system_->run(&run, this, &executor->m_worker_counter_);
+        }
+
+        Result await_resume() {
+            if constexpr (!std::is_void_v<Result>) {
+                return std::move(*result);
+            }
+        }
+    };
+
+    template <typename Predicate>
+    struct PollAwaiter {
+        TaskExecutor* executor;
+        Predicate predicate;
+        PollNode node;
+
+        static bool poll(void* awaiter) {
+            return static_cast<PollAwaiter*>(awaiter)->predicate();
+        }
+
+        bool await_ready() {
+            return predicate();
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            node = {handle, executor->m_polled_head_, this, &poll};
+            executor->m_polled_head_ = &node;
+        }
+
+        void await_resume() const noexcept {}
+    };
+public:
+    TaskExecutor(Arena& permanent_arena, jobs::JobSystem& job_system);
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+    TaskExecutor(TaskExecutor&&) = delete;
+    TaskExecutor& operator=(TaskExecutor&&) = delete;
+
+    // Takes ownership of the task and runs it up to its first co_await
+    void spawn(Task<void>&& task);
+    // Called once per frame. Resumes everything that became ready since the
+    // last tick and frees the top level tasks that finished.
+    void tick();
+    // Thread safe
+    void schedule(ScheduledNode* node);
+    [[nodiscard]] size_t get_task_count() const;
+
+    // co_await next_frame() suspends until the next tick
+    NextFrameAwaiter next_frame();
+    // Runs function on a job system worker and resumes with its result on the
+    // next tick after it finishes
+    template <typename Fn>
+    WorkerAwaiter<std::decay_t<Fn>> run_on_worker(Fn&& function);
+    // Checks predicate once per tick, for things like GPU fences
+    template <typename Predicate>
+    PollAwaiter<std::decay_t<Predicate>> wait_until(Predicate&& predicate);
+};
+
+template <typename Fn>
+TaskExecutor::WorkerAwaiter<std::decay_t<Fn>> TaskExecutor::run_on_worker(Fn&& function) {
+    return {this, std::forward<Fn>(function), {}, {}};
+}
+
+template <typename Predicate>
+TaskExecutor::PollAwaiter<std::decay_t<Predicate>> TaskExecutor::wait_until(Predicate&& predicate) {
+    return {this, std::forward<Predicate>(predicate), {}};
+}
+
+}
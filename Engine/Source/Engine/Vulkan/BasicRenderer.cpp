@@ -3,6 +3,7 @@
 #include <cassert>
 #include <stdexcept>
 
+#include "Engine/Profiling/Profiler.h"
 namespace engine::vulkan {
 
 BasicRenderer::BasicRenderer(Arena& temp_arena, Arena& permanent_arena, Window* window, DeviceWrapper* device, VkSurfaceKHR surface) : m_window_(window), m_device_(device),
@@ -14,9 +15,19 @@ VkCommandPool BasicRenderer::get_command_pool() const {
 }
 
 VkCommandBuffer BasicRenderer::begin_frame(Arena& temp_arena, Arena& permanent_arena) {
+    PROFILE_ZONE("begin_frame");
     assert(!m_is_frame_in_progress_ && "Cannot call begin_frame while another is in progress");
-    m_command_buffer_.wait_for_fence(m_current_frame_);
-    if (auto res = vkAcquireNextImageKHR(*m_device_, *m_swap_chain_, UINT64_MAX, m_command_buffer_.get_image_available_semaphore(m_current_frame_), VK_NULL_HANDLE, &m_current_image_index_); res != VK_SUCCESS) {
+    m_frame_timings_ = {};
+    const uint64_t wait_start_ns = profiling::Profiler::now_ns();
+    {
+        PROFILE_ZONE("wait_for_fence");
+        m_command_buffer_.wait_for_fence(m_current_frame_);
+    }
+    const uint64_t acquire_start_ns = profiling::Profiler::now_ns();
+    m_frame_timings_.fence_wait_ns = acquire_start_ns - wait_start_ns;
+    const VkResult res = vkAcquireNextImageKHR(*m_device_, *m_swap_chain_, UINT64_MAX, m_command_buffer_.get_image_available_semaphore(m_current_frame_), VK_NULL_HANDLE, &m_current_image_index_);
+    m_frame_timings_.acquire_ns = profiling::Profiler::now_ns() - acquire_start_ns;
+    if (res != VK_SUCCESS) {
         if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
             recreate_swap_chain(temp_arena, permanent_arena);
             return nullptr;
@@ -38,13 +49,17 @@ VkCommandBuffer BasicRenderer::begin_frame(Arena& temp_arena, Arena& permanent_a
 }
 
 void BasicRenderer::end_frame(Arena& temp_arena, Arena& permanent_arena) {
+    PROFILE_ZONE("end_frame");
     assert(m_is_frame_in_progress_ && "Can't end frame when there's no frame to end");
     VkCommandBuffer current_cmd_buffer = get_current_cmd_buffer();
     if (vkEndCommandBuffer(current_cmd_buffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to record command buffer!");
     }
     m_command_buffer_.submit_command_buffer(m_current_frame_);
-    if (m_command_buffer_.present_command_buffer(m_current_frame_, m_current_image_index_) || m_window_->was_resized()) {
+    const uint64_t present_start_ns = profiling::Profiler::now_ns();
+    const bool is_out_of_date = m_command_buffer_.present_command_buffer(m_current_frame_, m_current_image_index_);
+    m_frame_timings_.present_ns = profiling::Profiler::now_ns() - present_start_ns;
+    if (is_out_of_date || m_window_->was_resized()) {
         m_window_->toggle_resized();
         recreate_swap_chain(temp_arena, permanent_arena);
     }
@@ -112,6 +127,10 @@ float BasicRenderer::get_aspect_ratio() const {
     return static_cast<float>(extent.width) / static_cast<float>(extent.height);
 }
 
+FrameTimings BasicRenderer::get_frame_timings() const {
+    return m_frame_timings_;
+}
+
 void BasicRenderer::bind_pipeline(VkPipeline pipeline) {
     m_command_buffer_.bind_command_buffer(pipeline, m_current_frame_);
 }
@@ -123,6 +142,7 @@ ObjectHolder<SwapChain> BasicRenderer::initialize_swap_chain(Arena& temp_arena,
 }
 
 void BasicRenderer::recreate_swap_chain(Arena& temp_arena, Arena& permanent_arena) {
+    PROFILE_ZONE("recreate_swap_chain");
     vkDeviceWaitIdle(*m_device_);
     m_swap_chain_.emplace(m_swap_chain_->get_starting_stack_pos(), temp_arena, permanent_arena, m_window_->raw_window(), m_surface_, m_device_);
 }
@@ -2,19 +2,21 @@
 
 #include "Containers/ObjectHolder.h"
 #include "Memory/Arena.h"
+#include "Renderer.h"
 #include "Wrappers/CommandBufferWrapper.h"
 #include "Wrappers/DeviceWrapper.h"
 #include "Wrappers/SwapChain.h"
 
 namespace engine::vulkan {
 
-class BasicRenderer {
+class BasicRenderer final : public Renderer {
     Window* m_window_;
     DeviceWrapper* m_device_;
     VkSurfaceKHR m_surface_;
     ObjectHolder<SwapChain> m_swap_chain_;
     CommandBufferWrapper m_command_buffer_;
 
+    FrameTimings m_frame_timings_{};
     uint32_t m_current_frame_ = 0;
     uint32_t m_current_image_index_ = 0;
     bool m_is_frame_in_progress_ = false;
@@ -24,22 +26,23 @@ public:
     BasicRenderer(BasicRenderer&&) = delete;
     BasicRenderer& operator=(const BasicRenderer&) = delete;
     BasicRenderer& operator=(BasicRenderer&&) = delete;
-    ~BasicRenderer() = default;
+    ~BasicRenderer() override = default;
 
-    VkCommandPool get_command_pool() const;
-    VkCommandBuffer begin_frame(Arena& temp_arena, Arena& permanent_arena);
-    void end_frame(Arena& temp_arena, Arena& permanent_arena);
-    void begin_render_pass(VkCommandBuffer command_buffer);
-    void end_render_pass(VkCommandBuffer command_buffer) const;
+    VkCommandPool get_command_pool() const override;
+    VkCommandBuffer begin_frame(Arena& temp_arena, Arena& permanent_arena) override;
+    void end_frame(Arena& temp_arena, Arena& permanent_arena) override;
+    void begin_render_pass(VkCommandBuffer command_buffer) override;
+    void end_render_pass(VkCommandBuffer command_buffer) const override;
 
     [[nodiscard]] bool is_frame_in_progress() const;
     [[nodiscard]] VkCommandBuffer get_current_cmd_buffer() const;
     [[nodiscard]] VkRenderPass get_render_pass() const;
 
     [[nodiscard]] VkExtent2D get_swap_chain_extent() const;
-    [[nodiscard]] float get_aspect_ratio() const;
+    [[nodiscard]] float get_aspect_ratio() const override;
+    [[nodiscard]] FrameTimings get_frame_timings() const override;
 
-    void bind_pipeline(VkPipeline pipeline);
+    void bind_pipeline(VkPipeline pipeline) override;
     
     ObjectHolder<SwapChain> initialize_swap_chain(Arena& temp_arena, Arena& permanent_arena);
     void recreate_swap_chain(Arena& temp_arena, Arena& permanent_arena);
@@ -86,4 +86,12 @@ const glm::mat4& Camera::get_projection() const {
 
 const glm::mat4& Camera::get_view() const {
     return view;
+}
+
+void Camera::set_lod_threshold(float threshold) {
+    lod_threshold = threshold;
+}
+
+float Camera::get_lod_threshold() const {
+    return lod_threshold;
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 class Camera {
     glm::mat4 projection{1.f};
     glm::mat4 view{1.f};
+    // Share of the screen's height a LOD's error may cover, about a pixel at 1080p
+    float lod_threshold = 1.f / 1080.f;
 public:
     Camera() = default;
     Camera(float fov_y, float aspect, float near, float far);
@@ -12,7 +14,10 @@ public:
     void set_view_direction(glm::vec3 position, glm::vec3 direction, glm::vec3 up = {0.f, -1.f, 0.f});
     void set_view_target(glm::vec3 position, glm::vec3 target, glm::vec3 up = {0.f, -1.f, 0.f});
     void set_view_yxz(glm::vec3 position, glm::vec3 rotation);
+    // 0 always draws the full meshes
+    void set_lod_threshold(float threshold);
 
     const glm::mat4& get_projection() const;
     const glm::mat4& get_view() const;
+    float get_lod_threshold() const;
 };
@@ -0,0 +1,41 @@
+#include "NullRenderer.h"
+
+namespace engine::vulkan {
+
+NullRenderer::NullRenderer(VkExtent2D extent) : m_extent_(extent) {
+    
+}
+
+VkCommandBuffer NullRenderer::begin_frame(Arena&, Arena&) {
+    return VK_NULL_HANDLE;
+}
+
+void NullRenderer::end_frame(Arena&, Arena&) {
+    
+}
+
+void NullRenderer::begin_render_pass(VkCommandBuffer) {
+    
+}
+
+void NullRenderer::end_render_pass(VkCommandBuffer) const {
+    
+}
+
+void NullRenderer::bind_pipeline(VkPipeline) {
+    
+}
+
+VkCommandPool NullRenderer::get_command_pool() const {
+    return VK_NULL_HANDLE;
+}
+
+float NullRenderer::get_aspect_ratio() const {
+    return static_cast<float>(m_extent_.width) / static_cast<float>(m_extent_.height);
+}
+
+FrameTimings NullRenderer::get_frame_timings() const {
+    return {};
+}
+
+}
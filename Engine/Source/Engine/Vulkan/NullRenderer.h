@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Renderer.h"
+
+namespace engine::vulkan {
+
+// Renderer for headless runs. Never hands out a command buffer, so the frame
+// loop still simulates and builds its render list but records nothing.
+class NullRenderer final : public Renderer {
+    VkExtent2D m_extent_;
+public:
+    explicit NullRenderer(VkExtent2D extent);
+    ~NullRenderer() override = default;
+
+    VkCommandBuffer begin_frame(Arena& temp_arena, Arena& permanent_arena) override;
+    void end_frame(Arena& temp_arena, Arena& permanent_arena) override;
+    void begin_render_pass(VkCommandBuffer command_buffer) override;
+    void end_render_pass(VkCommandBuffer command_buffer) const override;
+    void bind_pipeline(VkPipeline pipeline) override;
+
+    [[nodiscard]] VkCommandPool get_command_pool() const override;
+    [[nodiscard]] float get_aspect_ratio() const override;
+    [[nodiscard]] FrameTimings get_frame_timings() const override;
+};
+
+}
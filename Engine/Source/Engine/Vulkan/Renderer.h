@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+#include "Memory/Arena.h"
+
+namespace engine::vulkan {
+
+// Time the last begin_frame and end_frame spent blocked on the GPU or the
+// presentation engine
+struct FrameTimings {
+    uint64_t fence_wait_ns;
+    uint64_t acquire_ns;
+    uint64_t present_ns;
+};
+
+// What the frame loop needs from a renderer. BasicRenderer draws through
+// Vulkan, NullRenderer stands in when the engine runs headless.
+class Renderer {
+public:
+    Renderer() = default;
+    Renderer(const Renderer&) = delete;
+    Renderer(Renderer&&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+    Renderer& operator=(Renderer&&) = delete;
+    virtual ~Renderer() = default;
+
+    // VK_NULL_HANDLE means there is nothing to record this frame
+    virtual VkCommandBuffer begin_frame(Arena& temp_arena, Arena& permanent_arena) = 0;
+    virtual void end_frame(Arena& temp_arena, Arena& permanent_arena) = 0;
+    virtual void begin_render_pass(VkCommandBuffer command_buffer) = 0;
+    virtual void end_render_pass(VkCommandBuffer command_buffer) const = 0;
+    virtual void bind_pipeline(VkPipeline pipeline) = 0;
+
+    [[nodiscard]] virtual VkCommandPool get_command_pool() const = 0;
+    [[nodiscard]] virtual float get_aspect_ratio() const = 0;
+    [[nodiscard]] virtual FrameTimings get_frame_timings() const = 0;
+};
+
+}
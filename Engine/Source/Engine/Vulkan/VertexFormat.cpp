@@ -0,0 +1,152 @@
+#include "VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "VulkanModel.h"
+
+namespace engine::vulkan {
+
+namespace {
+
+VkVertexInputAttributeDescription make_attribute(uint32_t location, VkFormat format, uint32_t offset) {
+    VkVertexInputAttributeDescription attribute{};
+    attribute.binding = 0;
+    attribute.location = location;
+    attribute.format = format;
+    attribute.offset = offset;
+    return attribute;
+}
+
+int16_t encode_snorm(float value) {
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+}
+
+uint32_t get_vertex_stride(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::QUANTIZED:
+            return sizeof(QuantizedVertex);
+        case VertexFormat::QUANTIZED_STRIPPED:
+            return sizeof(StrippedVertex);
+        case VertexFormat::FLOAT:
+        default:
+            return sizeof(VulkanModel::Vertex);
+    }
+}
+
+VertexLayout get_vertex_layout(VertexFormat format) {
+    VertexLayout layout{};
+    layout.binding = VulkanModel::Vertex::get_binding_descriptions();
+    layout.binding.stride = get_vertex_stride(format);
+    switch (format) {
+        case VertexFormat::QUANTIZED:
+            layout.attributes = {
+                make_attribute(0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(QuantizedVertex, position)),
+                make_attribute(1, VK_FORMAT_R8G8B8A8_UNORM, offsetof(QuantizedVertex, color)),
+                make_attribute(2, VK_FORMAT_R16G16_SNORM, offsetof(QuantizedVertex, normal)),
+                make_attribute(3, VK_FORMAT_R16G16_SFLOAT, offsetof(QuantizedVertex, uv)),
+            };
+            layout.attribute_count = 4;
+            // triangle.frag only shades with the color, so triangle.vert reads
+            // everything that's used. quantized.vert decodes the normal and uv
+            // for a fragment stage that lights the mesh.
+            layout.vertex_shader_path = "../Engine/Shaders/triangle.vert.spv";
+            break;
+        case VertexFormat::QUANTIZED_STRIPPED:
+            layout.attributes[0] = make_attribute(0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(StrippedVertex, position));
+            layout.attributes[1] = make_attribute(1, VK_FORMAT_R8G8B8A8_UNORM, offsetof(StrippedVertex, color));
+            layout.attribute_count = 2;
+            layout.vertex_shader_path = "../Engine/Shaders/triangle.vert.spv";
+            break;
+        case VertexFormat::FLOAT:
+        default: {
+            const auto attributes = VulkanModel::Vertex::get_attribute_descriptions();
+            std::copy(attributes.begin(), attributes.end(), layout.attributes.begin());
+            layout.attribute_count = static_cast<uint32_t>(attributes.size());
+            layout.vertex_shader_path = "../Engine/Shaders/triangle.vert.spv";
+            break;
+        }
+    }
+    return layout;
+}
+
+glm::mat4 get_position_transform(const glm::vec3& bounds_min, const glm::vec3& bounds_max) {
+    glm::mat4 transform{1.f};
+    for (int axis = 0; axis < 3; axis++) {
+        transform[axis][axis] = bounds_max[axis] - bounds_min[axis];
+        transform[3][axis] = bounds_min[axis];
+    }
+    return transform;
+}
+
+void quantize_position(const glm::vec3& position, const glm::vec3& bounds_min, const glm::vec3& bounds_max, uint16_t* quantized) {
+    for (int axis = 0; axis < 3; axis++) {
+        const float extent = bounds_max[axis] - bounds_min[axis];
+        const float fraction = extent > 0.f ? (position[axis] - bounds_min[axis]) / extent : 0.f;
+        quantized[axis] = static_cast<uint16_t>(std::lround(std::clamp(fraction, 0.f, 1.f) * 65535.f));
+    }
+    quantized[3] = 0;
+}
+
+void encode_octahedral(const glm::vec3& normal, int16_t* encoded) {
+    const float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    // Missing normals come out pointing along +z
+    if (length == 0.f) {
+        encoded[0] = 0;
+        encoded[1] = 0;
+        return;
+    }
+    float x = normal.x / length;
+    float y = normal.y / length;
+    if (normal.z < 0.f) {
+        const float folded_x = (1.f - std::fabs(y)) * (x >= 0.f ? 1.f : -1.f);
+        const float folded_y = (1.f - std::fabs(x)) * (y >= 0.f ? 1.f : -1.f);
+        x = folded_x;
+        y = folded_y;
+    }
+    encoded[0] = encode_snorm(x);
+    encoded[1] = encode_snorm(y);
+}
+
+uint16_t encode_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t magnitude = bits & 0x7fffffffu;
+    if (magnitude >= 0x7f800000u) {
+        // Infinity stays infinity, NaN stays a NaN
+        return static_cast<uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x200u : 0u));
+    }
+    if (magnitude >= 0x477ff000u) {
+        return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    if (magnitude < 0x38800000u) {
+        // Below the smallest normal half, shift into a subnormal with rounding
+        if (magnitude < 0x33000000u) {
+            return static_cast<uint16_t>(sign);
+        }
+        const uint32_t exponent = magnitude >> 23;
+        const uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+        const uint32_t shift = 126 - exponent;
+        const uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        return static_cast<uint16_t>(sign | (half + (remainder > halfway || (remainder == halfway && (half & 1u)) ? 1u : 0u)));
+    }
+    // Rebias the exponent and round the mantissa to nearest even
+    const uint32_t rebiased = magnitude - 0x38000000u;
+    const uint32_t rounded = rebiased + 0xfffu + ((rebiased >> 13) & 1u);
+    return static_cast<uint16_t>(sign | (rounded >> 13));
+}
+
+void encode_color(const glm::vec3& color, uint8_t* encoded) {
+    for (int channel = 0; channel < 3; channel++) {
+        encoded[channel] = static_cast<uint8_t>(std::lround(std::clamp(color[channel], 0.f, 1.f) * 255.f));
+    }
+    encoded[3] = 255;
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+
+#include <array>
+#include <cstdint>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+namespace engine::vulkan {
+
+// Layout of the vertex buffers models upload and the pipeline reads. Cooked
+// meshes stay float, models are encoded while they are staged.
+enum class VertexFormat : uint8_t {
+    // VulkanModel::Vertex as is, 44 bytes
+    FLOAT,
+    // QuantizedVertex, 20 bytes
+    QUANTIZED,
+    // StrippedVertex, only what triangle.vert reads, 12 bytes
+    QUANTIZED_STRIPPED,
+};
+
+// Positions are 16 bit fractions of the mesh bounds that the model's
+// position transform scales back, w is padding since three channel 16 bit
+// formats are rarely supported. Normals are octahedral, uvs half floats.
+struct QuantizedVertex {
+    uint16_t position[4];
+    int16_t normal[2];
+    uint16_t uv[2];
+    uint8_t color[4];
+};
+
+struct StrippedVertex {
+    uint16_t position[4];
+    uint8_t color[4];
+};
+
+struct VertexLayout {
+    VkVertexInputBindingDescription binding;
+    std::array<VkVertexInputAttributeDescription, 4> attributes;
+    uint32_t attribute_count;
+    const char* vertex_shader_path;
+};
+
+uint32_t get_vertex_stride(VertexFormat format);
+VertexLayout get_vertex_layout(VertexFormat format);
+
+// Maps the unit cube quantized positions live in onto the bounds
+glm::mat4 get_position_transform(const glm::vec3& bounds_min, const glm::vec3& bounds_max);
+void quantize_position(const glm::vec3& position, const glm::vec3& bounds_min, const glm::vec3& bounds_max, uint16_t* quantized);
+// Folds the lower hemisphere over the upper one, quantized.vert undoes it
+void encode_octahedral(const glm::vec3& normal, int16_t* encoded);
+uint16_t encode_half(float value);
+void encode_color(const glm::vec3& color, uint8_t* encoded);
+
+}
@@ -1,17 +1,29 @@
 ﻿#include "VulkanModel.h"
 
+#include <algorithm>
 #include <array>
-#include <fstream>
 #include <iostream>
+#include <utility>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <unordered_map>
-
-#include "../Vendor/tiny_obj_loader/tiny_obj_loader.h"
-#include "Memory/STLArenaAllocator.h"
+#include "Engine/Assets/CookedMesh.h"
+#include "Engine/Assets/MappedFile.h"
+#include "Engine/Assets/MeshOptimizer.h"
+#include "Engine/Assets/MeshSimplifier.h"
+#include "Engine/Assets/ObjParser.h"
+#include "Engine/Assets/VertexWeld.h"
+#include "Engine/Profiling/Profiler.h"
 
 namespace engine::vulkan {
 
+namespace {
+
+// Below this the draw call costs more than the triangles
+constexpr uint32_t min_lod_index_count = 3 * 64;
+// A level has to drop at least a quarter of the triangles before it to be kept
+constexpr float min_lod_reduction = 0.75f;
+
+}
+
 VkVertexInputBindingDescription VulkanModel::Vertex::
 get_binding_descriptions() {
     VkVertexInputBindingDescription binding_description;
@@ -39,73 +51,170 @@ get_attribute_descriptions() {
 }
 
 VulkanModel::VertexIndexInfo::VertexIndexInfo(Arena& model_arena)
-: vertices(model_arena), indices(model_arena) {
+: vertices(model_arena), indices(model_arena), lods(model_arena),
+    meshlets(model_arena), meshlet_vertices(model_arena), meshlet_triangles(model_arena) {
     
 }
 
-void VulkanModel::VertexIndexInfo::load_model(Arena& temp_arena, const char* file_path) {
+void VulkanModel::VertexIndexInfo::load_model(Arena& temp_arena, const char* file_path, jobs::JobSystem* job_system) {
+    assets::MappedFile file;
+    file.open(file_path);
+    load_model(temp_arena, file, file_path, job_system);
+}
+
+void VulkanModel::VertexIndexInfo::load_model(Arena& temp_arena, const assets::MappedFile& file, const char* file_path, jobs::JobSystem* job_system) {
+    PROFILE_ZONE("parse_obj");
     vertices.clear();
     indices.clear();
-    
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string err;
-    std::string warn;
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file_path)) {
-        std::cerr << err.c_str() << std::endl;
+    lods.clear();
+    meshlets.clear();
+    meshlet_vertices.clear();
+    meshlet_triangles.clear();
+
+    if (!file.is_open()) {
+        std::cerr << "Failed to open " << file_path << std::endl;
         return;
     }
-    using ArenaAllocator = STLArenaAllocator<std::pair<const Vertex, uint32_t>>;
-    std::unordered_map<Vertex, uint32_t, std::hash<Vertex>, std::equal_to<>, ArenaAllocator> index_map{ArenaAllocator{&temp_arena}};
-    for (const auto& shape : shapes) {
-        for (const auto& index : shape.mesh.indices) {
-            Vertex vertex;
-            if (index.vertex_index >= 0) {
-                vertex.position = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]};
-
-                size_t color_index = 3 * index.vertex_index + 2;
-                if (color_index < attrib.colors.size()) {
-                    vertex.color = {
-                    attrib.colors[color_index - 2],
-                    attrib.colors[color_index - 1],
-                    attrib.colors[color_index - 0]
-                    };
-                }
-                else {
-                    vertex.color = {0, 0, 0};
-                }
-            }
-            if (index.normal_index >= 0) {
-                vertex.normal = {
-                attrib.normals[3 * index.normal_index + 0],
-                attrib.normals[3 * index.normal_index + 1],
-                attrib.normals[3 * index.normal_index + 2]
-                };
-            }
-            if (index.texcoord_index >= 0) {
-                vertex.uv = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                attrib.texcoords[2 * index.texcoord_index + 1]
-                };
+    assets::ObjStreams streams{temp_arena};
+    const char* text = reinterpret_cast<const char*>(file.data());
+    const bool is_parsed = job_system != nullptr ? assets::parse_obj_parallel(*job_system, text, file.size(), streams) : assets::parse_obj(text, file.size(), streams);
+    if (!is_parsed) {
+        std::cerr << "Failed to parse " << file_path << std::endl;
+        return;
+    }
+    build_from_obj(temp_arena, streams, job_system);
+    optimize(temp_arena);
+    generate_lods(temp_arena);
+    build_meshlets(temp_arena);
+    temp_arena.clear();
+}
+
+void VulkanModel::VertexIndexInfo::build_from_obj(Arena& temp_arena, const assets::ObjStreams& streams, jobs::JobSystem* job_system) {
+    DynArray<Vertex> unindexed_vertices{temp_arena};
+    unindexed_vertices.push_back_n({}, streams.corners.size());
+    const auto expand = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const assets::ObjCorner& corner = streams.corners[i];
+            Vertex& vertex = unindexed_vertices[i];
+            vertex.position = streams.positions[corner.position];
+            vertex.color = streams.colors[corner.position];
+            if (corner.normal != assets::ObjCorner::NO_INDEX) {
+                vertex.normal = streams.normals[corner.normal];
             }
-            if (index_map.count(vertex) == 0) {
-                index_map[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
+            if (corner.uv != assets::ObjCorner::NO_INDEX) {
+                vertex.uv = streams.uvs[corner.uv];
             }
-            indices.push_back(index_map[vertex]);
         }
+    };
+    if (job_system != nullptr) {
+        job_system->parallel_for(unindexed_vertices.size(), 1 << 14, expand);
+    } else {
+        expand(0, unindexed_vertices.size());
+    }
+    weld(temp_arena, unindexed_vertices.data(), unindexed_vertices.size());
+}
+
+void VulkanModel::VertexIndexInfo::weld(Arena& temp_arena, const Vertex* unindexed_vertices, size_t vertex_count, float weld_epsilon) {
+    static_assert(sizeof(Vertex) == 11 * sizeof(float), "Vertex is welded by its bytes, it can't have padding");
+    vertices.clear();
+    indices.clear();
+    lods.clear();
+    meshlets.clear();
+    meshlet_vertices.clear();
+    meshlet_triangles.clear();
+    indices.push_back_n(0, vertex_count);
+    const uint32_t unique_count = assets::weld_vertices(temp_arena, unindexed_vertices, vertex_count, sizeof(Vertex), sizeof(Vertex), weld_epsilon, indices.data());
+    vertices.reserve(unique_count);
+    for (size_t i = 0; i < vertex_count; i++) {
+        if (indices[i] == vertices.size()) {
+            vertices.push_back(unindexed_vertices[i]);
+        }
+    }
+}
+
+void VulkanModel::VertexIndexInfo::optimize(Arena& temp_arena, bool sort_for_overdraw) {
+    PROFILE_ZONE("optimize_mesh");
+    assert(lods.is_empty() && "LODs have to be generated after optimizing");
+    if (indices.is_empty()) {
+        return;
+    }
+    assets::optimize_vertex_cache(temp_arena, indices.data(), indices.size(), vertices.size());
+    if (sort_for_overdraw) {
+        assets::optimize_overdraw(temp_arena, indices.data(), indices.size(), &vertices.data()->position.x, sizeof(Vertex), vertices.size());
+    }
+    const size_t used_count = assets::optimize_vertex_fetch(temp_arena, indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(Vertex));
+    while (vertices.size() > used_count) {
+        vertices.pop_back();
+    }
+}
+
+void VulkanModel::VertexIndexInfo::generate_lods(Arena& temp_arena, uint32_t max_lod_count, float max_error) {
+    PROFILE_ZONE("generate_lods");
+    assert(lods.is_empty() && "LODs were already generated");
+    if (indices.is_empty()) {
+        return;
+    }
+    lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.f, 0, 0});
+    glm::vec3 bounds_min = vertices[0].position;
+    glm::vec3 bounds_max = vertices[0].position;
+    for (const Vertex& vertex : vertices) {
+        bounds_min = glm::min(bounds_min, vertex.position);
+        bounds_max = glm::max(bounds_max, vertex.position);
+    }
+    const float max_distance = glm::length(bounds_max - bounds_min) * max_error;
+
+    // Every level simplifies the one before it, which is much cheaper than
+    // starting from the full mesh each time. Their errors add up.
+    indices.reserve(indices.size() * 2);
+    auto* simplified = static_cast<uint32_t*>(temp_arena.push(indices.size() * sizeof(uint32_t), alignof(uint32_t)));
+    assert(simplified != nullptr && "Temp arena is too small for the LODs");
+    while (lods.size() < max_lod_count) {
+        const MeshLod previous = lods[lods.size() - 1];
+        const size_t target_index_count = previous.index_count / 6 * 3;
+        if (target_index_count < min_lod_index_count) {
+            break;
+        }
+        float error;
+        const size_t index_count = assets::simplify(temp_arena, indices.data() + previous.index_offset, previous.index_count,
+            &vertices.data()->position.x, &vertices.data()->normal.x, sizeof(Vertex), vertices.size(),
+            target_index_count, max_distance - previous.error, simplified, &error);
+        if (static_cast<float>(index_count) > static_cast<float>(previous.index_count) * min_lod_reduction) {
+            break;
+        }
+        assets::optimize_vertex_cache(temp_arena, simplified, index_count, vertices.size());
+        lods.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(index_count), previous.error + error, 0, 0});
+        indices.push_back_range(simplified, index_count);
     }
-    temp_arena.clear();
 }
 
-void VulkanModel::create_buffer_from_staging(DeviceWrapper* device_wrapper, VkCommandPool command_pool, VkDeviceSize size, VkBufferUsageFlags usage, void* data_to_copy, VkBuffer& buffer, VkDeviceMemory& buffer_memory) {
-    VkBuffer staging_buffer;
-    VkDeviceMemory staging_buffer_memory;
+void VulkanModel::VertexIndexInfo::build_meshlets(Arena& temp_arena) {
+    PROFILE_ZONE("build_meshlets");
+    if (lods.is_empty()) {
+        lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.f, 0, 0});
+    }
+    meshlets.clear();
+    meshlet_vertices.clear();
+    meshlet_triangles.clear();
+    for (MeshLod& lod : lods) {
+        lod.meshlet_offset = static_cast<uint32_t>(meshlets.size());
+        lod.meshlet_count = assets::build_meshlets(temp_arena, indices.data() + lod.index_offset, lod.index_count, &vertices.data()->position.x, sizeof(Vertex), vertices.size(),
+            meshlets, meshlet_vertices, meshlet_triangles);
+    }
+}
+
+VulkanModel::MeshData VulkanModel::VertexIndexInfo::get_mesh_data() const {
+    return {vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(), static_cast<uint32_t>(indices.size()), sizeof(uint32_t),
+        lods.data(), static_cast<uint32_t>(lods.size()),
+        meshlets.data(), static_cast<uint32_t>(meshlets.size()),
+        meshlet_vertices.data(), static_cast<uint32_t>(meshlet_vertices.size()),
+        meshlet_triangles.data(), static_cast<uint32_t>(meshlet_triangles.size())};
+}
+
+bool VulkanModel::PendingUpload::is_complete(VkDevice device) const {
+    return vkGetFenceStatus(device, fence) == VK_SUCCESS;
+}
+
+void* VulkanModel::create_staging_buffer(DeviceWrapper* device_wrapper, VkDeviceSize size, VkBuffer& staging_buffer, VkDeviceMemory& staging_buffer_memory) {
     device_wrapper->create_buffer(size,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
@@ -114,34 +223,153 @@ void VulkanModel::create_buffer_from_staging(DeviceWrapper* device_wrapper, VkCo
 
     void* data;
     vkMapMemory(*device_wrapper, staging_buffer_memory, 0, size, 0, &data);
-    memcpy(data, data_to_copy, size);
-    vkUnmapMemory(*device_wrapper, staging_buffer_memory);
-    
-    device_wrapper->create_buffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        &buffer,
-        &buffer_memory);
+    return data;
+}
 
-    device_wrapper->copy_buffer(command_pool, staging_buffer, buffer, size);
+void VulkanModel::record_upload(VkCommandPool command_pool, const MeshData& mesh, PendingUpload& upload) {
+    const uint32_t index_size = get_index_size(m_vertex_count_);
+    m_index_type_ = index_size == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    const std::array<VkDeviceSize, 2> sizes{static_cast<VkDeviceSize>(get_vertex_stride(m_vertex_format_)) * m_vertex_count_, static_cast<VkDeviceSize>(index_size) * m_index_count_};
+    const std::array<VkBufferUsageFlags, 2> usages{VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_BUFFER_USAGE_INDEX_BUFFER_BIT};
+    const std::array<VkBuffer*, 2> buffers{&m_vertex_buffer_, &m_index_buffer_};
+    const std::array<VkDeviceMemory*, 2> buffer_memory{&m_vertex_buffer_memory_, &m_index_buffer_memory_};
 
-    vkDestroyBuffer(*device_wrapper, staging_buffer, nullptr);
-    vkFreeMemory(*device_wrapper, staging_buffer_memory, nullptr);
+    upload.command_buffer = m_device_wrapper_->get_one_time_command_buffer(command_pool);
+    const size_t buffer_count = m_index_count_ > 0 ? 2 : 1;
+    for (size_t i = 0; i < buffer_count; i++) {
+        void* staging = create_staging_buffer(m_device_wrapper_, sizes[i], upload.staging_buffers[i], upload.staging_buffer_memory[i]);
+        // Vertices are encoded straight into the staging memory
+        if (i == 0) {
+            m_position_transform_ = encode_vertices(mesh, m_vertex_format_, staging);
+        } else {
+            encode_indices(mesh, index_size, staging);
+        }
+        vkUnmapMemory(*m_device_wrapper_, upload.staging_buffer_memory[i]);
+        m_device_wrapper_->create_buffer(sizes[i], usages[i] | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            buffers[i],
+            buffer_memory[i]);
+        DeviceWrapper::record_copy_buffer(upload.command_buffer, upload.staging_buffers[i], *buffers[i], sizes[i]);
+    }
+    upload.fence = m_device_wrapper_->submit_one_time_command_buffer(upload.command_buffer);
 }
 
-VulkanModel::VulkanModel(DeviceWrapper* device_wrapper,
-                         VkCommandPool command_pool, const VertexIndexInfo& vertices) : m_device_wrapper_(device_wrapper) {
-    m_vertex_count_ = static_cast<uint32_t>(vertices.vertices.size());
-    m_index_count_ = static_cast<uint32_t>(vertices.indices.size());
+void VulkanModel::set_mesh_info(const MeshData& mesh) {
+    m_vertex_count_ = mesh.vertex_count;
+    m_index_count_ = mesh.index_count;
     assert(m_vertex_count_ > 3 && "Vertex count must be greater than 3");
-    VkDeviceSize vertex_buffer_size = sizeof(Vertex) * m_vertex_count_;
-    VkDeviceSize index_buffer_size = sizeof(uint32_t) * m_index_count_;
-    create_buffer_from_staging(device_wrapper, command_pool, vertex_buffer_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertices.vertices.data(), m_vertex_buffer_, m_vertex_buffer_memory_);
-    if (m_index_count_ > 0) {
-        create_buffer_from_staging(device_wrapper, command_pool, index_buffer_size, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, vertices.indices.data(), m_index_buffer_, m_index_buffer_memory_);
+    assert(mesh.lod_count <= MAX_LODS && "Mesh has more LODs than a model keeps");
+    m_lod_count_ = std::max(mesh.lod_count, 1u);
+    if (mesh.lod_count == 0) {
+        m_lods_[0] = {0, mesh.index_count, 0.f, 0, mesh.meshlet_count};
+    } else {
+        std::copy_n(mesh.lods, mesh.lod_count, m_lods_.begin());
+    }
+
+    glm::vec3 bounds_min = mesh.vertices[0].position;
+    glm::vec3 bounds_max = mesh.vertices[0].position;
+    for (uint32_t i = 1; i < mesh.vertex_count; i++) {
+        bounds_min = glm::min(bounds_min, mesh.vertices[i].position);
+        bounds_max = glm::max(bounds_max, mesh.vertices[i].position);
+    }
+    const glm::vec3 center = (bounds_min + bounds_max) * 0.5f;
+    float radius = 0.f;
+    for (uint32_t i = 0; i < mesh.vertex_count; i++) {
+        radius = std::max(radius, glm::length(mesh.vertices[i].position - center));
+    }
+    m_bounding_sphere_ = glm::vec4{center, radius};
+}
+
+VulkanModel::VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const MeshData& mesh, VertexFormat vertex_format)
+    : m_device_wrapper_(device_wrapper), m_index_type_(VK_INDEX_TYPE_UINT32), m_vertex_format_(vertex_format), m_position_transform_(1.f) {
+    set_mesh_info(mesh);
+    // Headless engines have no device, the model only keeps its counts
+    if (device_wrapper == nullptr) {
+        return;
+    }
+    PendingUpload upload{};
+    record_upload(command_pool, mesh, upload);
+    finish_upload(device_wrapper, command_pool, upload);
+}
+
+VulkanModel::VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const VertexIndexInfo& vertices, VertexFormat vertex_format)
+    : VulkanModel(device_wrapper, command_pool, vertices.get_mesh_data(), vertex_format) {
+}
+
+VulkanModel::VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const MeshData& mesh,
+    PendingUpload& upload, VertexFormat vertex_format) : m_device_wrapper_(device_wrapper), m_index_type_(VK_INDEX_TYPE_UINT32), m_vertex_format_(vertex_format), m_position_transform_(1.f) {
+    set_mesh_info(mesh);
+    record_upload(command_pool, mesh, upload);
+}
+
+void VulkanModel::finish_upload(DeviceWrapper* device_wrapper, VkCommandPool command_pool, PendingUpload& upload) {
+    vkWaitForFences(*device_wrapper, 1, &upload.fence, VK_TRUE, UINT64_MAX);
+    vkDestroyFence(*device_wrapper, upload.fence, nullptr);
+    vkFreeCommandBuffers(*device_wrapper, command_pool, 1, &upload.command_buffer);
+    for (size_t i = 0; i < upload.staging_buffers.size(); i++) {
+        if (upload.staging_buffers[i] != VK_NULL_HANDLE) {
+            vkDestroyBuffer(*device_wrapper, upload.staging_buffers[i], nullptr);
+            vkFreeMemory(*device_wrapper, upload.staging_buffer_memory[i], nullptr);
+        }
+    }
+    upload = {};
+}
+
+glm::mat4 VulkanModel::encode_vertices(const MeshData& mesh, VertexFormat format, void* destination) {
+    if (format == VertexFormat::FLOAT) {
+        memcpy(destination, mesh.vertices, sizeof(Vertex) * mesh.vertex_count);
+        return glm::mat4{1.f};
+    }
+    glm::vec3 bounds_min = mesh.vertices[0].position;
+    glm::vec3 bounds_max = mesh.vertices[0].position;
+    for (uint32_t i = 1; i < mesh.vertex_count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            bounds_min[axis] = std::min(bounds_min[axis], mesh.vertices[i].position[axis]);
+            bounds_max[axis] = std::max(bounds_max[axis], mesh.vertices[i].position[axis]);
+        }
+    }
+    if (format == VertexFormat::QUANTIZED) {
+        auto* quantized = static_cast<QuantizedVertex*>(destination);
+        for (uint32_t i = 0; i < mesh.vertex_count; i++) {
+            const Vertex& vertex = mesh.vertices[i];
+            quantize_position(vertex.position, bounds_min, bounds_max, quantized[i].position);
+            encode_octahedral(vertex.normal, quantized[i].normal);
+            quantized[i].uv[0] = encode_half(vertex.uv.x);
+            quantized[i].uv[1] = encode_half(vertex.uv.y);
+            encode_color(vertex.color, quantized[i].color);
+        }
+    } else {
+        auto* stripped = static_cast<StrippedVertex*>(destination);
+        for (uint32_t i = 0; i < mesh.vertex_count; i++) {
+            quantize_position(mesh.vertices[i].position, bounds_min, bounds_max, stripped[i].position);
+            encode_color(mesh.vertices[i].color, stripped[i].color);
+        }
+    }
+    return vulkan::get_position_transform(bounds_min, bounds_max);
+}
+
+uint32_t VulkanModel::get_index_size(uint32_t vertex_count) {
+    return vertex_count <= UINT16_MAX + 1u ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+void VulkanModel::encode_indices(const MeshData& mesh, uint32_t index_size, void* destination) {
+    if (index_size == mesh.index_size) {
+        memcpy(destination, mesh.indices, static_cast<size_t>(index_size) * mesh.index_count);
+        return;
+    }
+    assert(index_size == sizeof(uint16_t) && mesh.index_size == sizeof(uint32_t) && "Indices can only be narrowed");
+    assert(mesh.vertex_count <= UINT16_MAX + 1u && "Vertices don't fit 16 bit indices");
+    const auto* source = static_cast<const uint32_t*>(mesh.indices);
+    auto* narrowed = static_cast<uint16_t*>(destination);
+    for (uint32_t i = 0; i < mesh.index_count; i++) {
+        narrowed[i] = static_cast<uint16_t>(source[i]);
     }
 }
 
 VulkanModel::~VulkanModel() {
+    if (m_device_wrapper_ == nullptr) {
+        return;
+    }
     vkDeviceWaitIdle(*m_device_wrapper_);
     vkDestroyBuffer(*m_device_wrapper_, m_vertex_buffer_, nullptr);
     vkFreeMemory(*m_device_wrapper_, m_vertex_buffer_memory_, nullptr);
@@ -152,24 +380,90 @@ VulkanModel::~VulkanModel() {
     }
 }
 
-VulkanModel VulkanModel::load_model(Arena& temp_arena, Arena& model_arena, DeviceWrapper* device_wrapper, VkCommandPool command_pool, const char* file_path) {
-    std::ifstream file(file_path, std::ios::binary);
+VulkanModel::MeshData VulkanModel::load_mesh_data(Arena& temp_arena, const char* file_path, VertexIndexInfo& vertex_index_info, assets::CookedMesh& cooked_mesh, jobs::JobSystem* job_system) {
+    char cooked_path[1024];
+    assets::MappedFile file;
+    const bool is_cooked = assets::get_cooked_path(file_path, cooked_path, sizeof(cooked_path)) && file.open(cooked_path);
+    if (!is_cooked) {
+        file.open(file_path);
+    }
+    return load_mesh_data(temp_arena, file, is_cooked, file_path, vertex_index_info, cooked_mesh, job_system);
+}
+
+VulkanModel::MeshData VulkanModel::load_mesh_data(Arena& temp_arena, assets::MappedFile& file, bool is_cooked, const char* file_path, VertexIndexInfo& vertex_index_info,
+    assets::CookedMesh& cooked_mesh, jobs::JobSystem* job_system) {
+    if (is_cooked) {
+        if (cooked_mesh.open(std::move(file), file_path)) {
+            return cooked_mesh.get_mesh_data();
+        }
+        // Stale or corrupt, the OBJ gets parsed after all
+        file.open(file_path);
+    }
+    char cooked_path[1024];
+    const bool has_cooked_path = assets::get_cooked_path(file_path, cooked_path, sizeof(cooked_path));
+    vertex_index_info.load_model(temp_arena, file, file_path, job_system);
+    if (has_cooked_path && !assets::write_cooked_mesh(temp_arena, cooked_path, vertex_index_info.get_mesh_data(), file_path)) {
+        std::cerr << "Failed to cook " << cooked_path << "\n";
+    }
+    temp_arena.clear();
+    return vertex_index_info.get_mesh_data();
+}
+
+VulkanModel VulkanModel::load_model(Arena& temp_arena, Arena& model_arena, DeviceWrapper* device_wrapper, VkCommandPool command_pool, const char* file_path, jobs::JobSystem* job_system, VertexFormat vertex_format) {
+    PROFILE_ZONE("load_model");
     VertexIndexInfo vertex_index_info{model_arena};
-    vertex_index_info.load_model(temp_arena, file_path);
-    return {device_wrapper, command_pool, vertex_index_info};
+    assets::CookedMesh cooked_mesh;
+    return {device_wrapper, command_pool, load_mesh_data(temp_arena, file_path, vertex_index_info, cooked_mesh, job_system), vertex_format};
+}
+
+VertexFormat VulkanModel::get_vertex_format() const {
+    return m_vertex_format_;
+}
+
+const glm::mat4& VulkanModel::get_position_transform() const {
+    return m_position_transform_;
+}
+
+uint32_t VulkanModel::get_lod_count() const {
+    return m_lod_count_;
+}
+
+const VulkanModel::MeshLod& VulkanModel::get_lod(uint32_t lod) const {
+    return m_lods_[lod];
+}
+
+uint32_t VulkanModel::select_lod(const glm::mat4& transform, float lod_threshold) const {
+    // Clip space w is the view depth under a perspective projection and 1
+    // under an orthographic one. The row that gives it also says how fast it
+    // changes across the model, which finds the sphere's near side.
+    const glm::vec4 depth_row{transform[0][3], transform[1][3], transform[2][3], transform[3][3]};
+    const float depth = glm::dot(depth_row, glm::vec4{glm::vec3{m_bounding_sphere_}, 1.f}) - m_bounding_sphere_.w * glm::length(glm::vec3{depth_row});
+    if (depth <= 0.f) {
+        return 0;
+    }
+    // Model units to fractions of the screen's height, which spans 2 in NDC
+    const glm::vec3 height_row{transform[0][1], transform[1][1], transform[2][1]};
+    const float screen_scale = glm::length(height_row) / (2.f * depth);
+    for (uint32_t lod = m_lod_count_ - 1; lod > 0; lod--) {
+        if (m_lods_[lod].error * screen_scale <= lod_threshold) {
+            return lod;
+        }
+    }
+    return 0;
 }
 
 void VulkanModel::bind(VkCommandBuffer command_buffer) const {
     VkDeviceSize offset[] = {0};
     vkCmdBindVertexBuffers(command_buffer, 0, 1, &m_vertex_buffer_, offset);
     if (m_index_count_ > 0) {
-        vkCmdBindIndexBuffer(command_buffer, m_index_buffer_, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(command_buffer, m_index_buffer_, 0, m_index_type_);
     }
 }
 
-void VulkanModel::draw(VkCommandBuffer command_buffer) const {
+void VulkanModel::draw(VkCommandBuffer command_buffer, uint32_t lod) const {
+    assert(lod < m_lod_count_ && "Model has no such LOD");
     if (m_index_count_ > 0) {
-        vkCmdDrawIndexed(command_buffer, m_index_count_, 1, 0, 0, 0);
+        vkCmdDrawIndexed(command_buffer, m_lods_[lod].index_count, 1, m_lods_[lod].index_offset, 0, 0);
     } else {
         vkCmdDraw(command_buffer, m_vertex_count_, 1, 0, 0);
     }
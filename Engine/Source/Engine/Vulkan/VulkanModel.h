@@ -1,14 +1,29 @@
 ﻿#pragma once
 #include <vulkan/vulkan_core.h>
 
+#include <array>
+
+#include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 
 #include <glm/vec3.hpp>
 
 #include "Containers/ArrayRef.h"
 #include "Containers/DynArray.h"
+#include "Engine/Assets/Meshlets.h"
+#include "VertexFormat.h"
 #include "Wrappers/DeviceWrapper.h"
 
+namespace engine::assets {
+class CookedMesh;
+class MappedFile;
+struct ObjStreams;
+}
+
+namespace engine::jobs {
+class JobSystem;
+}
+
 namespace engine::vulkan {
 
 class VulkanModel {
@@ -27,12 +42,83 @@ public:
         }
     };
 
+    static constexpr uint32_t MAX_LODS = 8;
+
+    // A range of the index buffer drawing the mesh at one level of detail.
+    // LOD 0 is the full mesh, each one after it has about half the triangles.
+    struct MeshLod {
+        uint32_t index_offset;
+        uint32_t index_count;
+        // Furthest the simplified surface strays from the full mesh, in model units
+        float error;
+        // The same triangles as meshlets
+        uint32_t meshlet_offset;
+        uint32_t meshlet_count;
+    };
+
+    // What gets uploaded, either owned by a VertexIndexInfo or mapped
+    // straight from a cooked mesh file
+    struct MeshData {
+        const Vertex* vertices;
+        uint32_t vertex_count;
+        // uint16_t or uint32_t, index_size says which
+        const void* indices;
+        uint32_t index_count;
+        uint32_t index_size;
+        // Ranges of the indices, none means the whole index buffer is LOD 0
+        const MeshLod* lods;
+        uint32_t lod_count;
+        // Empty unless build_meshlets ran
+        const assets::Meshlet* meshlets;
+        uint32_t meshlet_count;
+        const uint32_t* meshlet_vertices;
+        uint32_t meshlet_vertex_count;
+        const uint8_t* meshlet_triangles;
+        uint32_t meshlet_triangle_size;
+    };
+
     struct VertexIndexInfo {
         VertexIndexInfo(Arena& model_arena);
         DynArray<Vertex> vertices;
         DynArray<uint32_t> indices;
+        DynArray<MeshLod> lods;
+        DynArray<assets::Meshlet> meshlets;
+        DynArray<uint32_t> meshlet_vertices;
+        DynArray<uint8_t> meshlet_triangles;
+
+        // Large files are parsed and expanded on job_system when one is given
+        void load_model(Arena& temp_arena, const char* file_path, jobs::JobSystem* job_system = nullptr);
+        // Same with the OBJ already mapped, file_path is only for messages
+        void load_model(Arena& temp_arena, const assets::MappedFile& file, const char* file_path, jobs::JobSystem* job_system = nullptr);
+        // Expands the parsed faces and welds them, streams may live in temp_arena
+        void build_from_obj(Arena& temp_arena, const assets::ObjStreams& streams, jobs::JobSystem* job_system = nullptr);
+        // Builds vertices and indices from an unindexed triangle list, vertices
+        // with the same bytes share one index. With weld_epsilon above zero,
+        // nearly equal ones do too.
+        void weld(Arena& temp_arena, const Vertex* unindexed_vertices, size_t vertex_count, float weld_epsilon = 0.f);
+        // Reorders triangles for the post transform cache, optionally sorts
+        // them against overdraw, then lays the vertices out in fetch order.
+        // load_model runs it without the overdraw sort.
+        void optimize(Arena& temp_arena, bool sort_for_overdraw = false);
+        // Appends simplified copies of the mesh to indices until a level would
+        // stray more than max_error of the mesh's size from the full mesh or
+        // stops shrinking. Runs after optimize, which expects a single LOD.
+        void generate_lods(Arena& temp_arena, uint32_t max_lod_count = MAX_LODS, float max_error = 0.05f);
+        // Splits every LOD into meshlets, run last since it doesn't follow
+        // changes to the indices
+        void build_meshlets(Arena& temp_arena);
+        [[nodiscard]] MeshData get_mesh_data() const;
+    };
+
+    // Staging copies still in flight on the GPU. Keep it alive until
+    // is_complete returns true, then hand it to finish_upload.
+    struct PendingUpload {
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+        std::array<VkBuffer, 2> staging_buffers{};
+        std::array<VkDeviceMemory, 2> staging_buffer_memory{};
 
-        void load_model(Arena& temp_arena, const char* file_path);
+        [[nodiscard]] bool is_complete(VkDevice device) const;
     };
     
 private:
@@ -43,50 +129,62 @@ private:
     VkDeviceMemory m_index_buffer_memory_;
     uint32_t m_vertex_count_;
     uint32_t m_index_count_;
-
-    static void create_buffer_from_staging(DeviceWrapper* device_wrapper, VkCommandPool command_pool, VkDeviceSize size, VkBufferUsageFlags usage, void* data_to_copy, VkBuffer& buffer, VkDeviceMemory& buffer_memory);
+    VkIndexType m_index_type_;
+    std::array<MeshLod, MAX_LODS> m_lods_;
+    uint32_t m_lod_count_;
+    // xyz is the center, w the radius
+    glm::vec4 m_bounding_sphere_;
+    VertexFormat m_vertex_format_;
+    // Scales quantized positions back to model space, identity for FLOAT
+    glm::mat4 m_position_transform_;
+
+    // Maps the staging buffer, the caller writes size bytes and unmaps it
+    static void* create_staging_buffer(DeviceWrapper* device_wrapper, VkDeviceSize size, VkBuffer& staging_buffer, VkDeviceMemory& staging_buffer_memory);
+    void record_upload(VkCommandPool command_pool, const MeshData& mesh, PendingUpload& upload);
+    void set_mesh_info(const MeshData& mesh);
 public:
-    VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const VertexIndexInfo& vertices);
+    VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const MeshData& mesh, VertexFormat vertex_format = VertexFormat::FLOAT);
+    VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const VertexIndexInfo& vertices, VertexFormat vertex_format = VertexFormat::FLOAT);
+    // Records the uploads without waiting on them, see PendingUpload
+    VulkanModel(DeviceWrapper* device_wrapper, VkCommandPool command_pool, const MeshData& mesh, PendingUpload& upload, VertexFormat vertex_format = VertexFormat::FLOAT);
     ~VulkanModel();
 
-    static VulkanModel load_model(Arena& temp_arena, Arena& model_arena, DeviceWrapper* device_wrapper, VkCommandPool command_pool, const char* file_path);
+    static void finish_upload(DeviceWrapper* device_wrapper, VkCommandPool command_pool, PendingUpload& upload);
+    // Writes the mesh's vertices in format to destination, get_vertex_stride
+    // apart, and returns the position transform they need
+    static glm::mat4 encode_vertices(const MeshData& mesh, VertexFormat format, void* destination);
+    // 2 when every vertex fits a 16 bit index, 4 otherwise
+    static uint32_t get_index_size(uint32_t vertex_count);
+    // Writes the mesh's indices as index_size bytes each, index_size may
+    // not be larger than get_index_size allows
+    static void encode_indices(const MeshData& mesh, uint32_t index_size, void* destination);
+
+    // Maps the cooked copy of file_path into cooked_mesh when it's current,
+    // otherwise parses the OBJ into vertex_index_info and cooks it for the
+    // next load. The result points into whichever of the two was used.
+    static MeshData load_mesh_data(Arena& temp_arena, const char* file_path, VertexIndexInfo& vertex_index_info, assets::CookedMesh& cooked_mesh, jobs::JobSystem* job_system = nullptr);
+    // Same with file already mapped by the caller, the cooked copy if
+    // is_cooked and the OBJ otherwise. A current cooked copy is handed over
+    // to cooked_mesh, a stale one is replaced by the OBJ.
+    static MeshData load_mesh_data(Arena& temp_arena, assets::MappedFile& file, bool is_cooked, const char* file_path, VertexIndexInfo& vertex_index_info,
+        assets::CookedMesh& cooked_mesh, jobs::JobSystem* job_system = nullptr);
+    static VulkanModel load_model(Arena& temp_arena, Arena& model_arena, DeviceWrapper* device_wrapper, VkCommandPool command_pool, const char* file_path, jobs::JobSystem* job_system = nullptr, VertexFormat vertex_format = VertexFormat::FLOAT);
 
     VulkanModel(const VulkanModel&) = delete;
     VulkanModel& operator=(const VulkanModel&) = delete;
     VulkanModel(VulkanModel&&) = delete;
     VulkanModel& operator=(VulkanModel&&) = delete;
 
+    [[nodiscard]] VertexFormat get_vertex_format() const;
+    [[nodiscard]] const glm::mat4& get_position_transform() const;
+    [[nodiscard]] uint32_t get_lod_count() const;
+    [[nodiscard]] const MeshLod& get_lod(uint32_t lod) const;
+    // Coarsest LOD whose error covers at most lod_threshold of the screen's
+    // height, with transform taking the model to clip space
+    [[nodiscard]] uint32_t select_lod(const glm::mat4& transform, float lod_threshold) const;
+
     void bind(VkCommandBuffer command_buffer) const;
-    void draw(VkCommandBuffer command_buffer) const;
+    void draw(VkCommandBuffer command_buffer, uint32_t lod = 0) const;
 };
 
 }
-
-template <typename T>
-void hash_combine(std::size_t& seed, const T& value) {
-    seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-}
-
-namespace std {
-template <>
-struct hash<engine::vulkan::VulkanModel::Vertex> {
-    size_t operator()(const engine::vulkan::VulkanModel::Vertex& vertex) const noexcept {
-        size_t seed = 0;
-        hash_combine(seed, vertex.position.x);
-        hash_combine(seed, vertex.position.y);
-        hash_combine(seed, vertex.position.z);
-
-        hash_combine(seed, vertex.color.x);
-        hash_combine(seed, vertex.color.y);
-        hash_combine(seed, vertex.color.z);
-
-        hash_combine(seed, vertex.normal.x);
-        hash_combine(seed, vertex.normal.y);
-        hash_combine(seed, vertex.normal.z);
-
-        hash_combine(seed, vertex.uv.x);
-        hash_combine(seed, vertex.uv.y);
-        return seed;
-    }
-};
-}
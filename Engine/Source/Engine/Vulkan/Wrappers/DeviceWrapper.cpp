@@ -170,16 +170,36 @@ void DeviceWrapper::end_one_time_command_buffer(VkCommandPool command_pool, VkCo
     vkFreeCommandBuffers(m_device_, command_pool, 1, &cmd_buffer);
 }
 
+VkFence DeviceWrapper::submit_one_time_command_buffer(VkCommandBuffer cmd_buffer) const {
+    vkEndCommandBuffer(cmd_buffer);
+    VkFenceCreateInfo fence_info{};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VkFence fence;
+    if (vkCreateFence(m_device_, &fence_info, nullptr, &fence) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to create fence");
+    }
+    VkSubmitInfo submit_info{};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &cmd_buffer;
+    vkQueueSubmit(m_graphics_queue_, 1, &submit_info, fence);
+    return fence;
+}
+
 void DeviceWrapper::copy_buffer(VkCommandPool command_pool, VkBuffer source_buffer, VkBuffer dest_buffer,
     VkDeviceSize size) const {
     VkCommandBuffer cmd_buffer = get_one_time_command_buffer(command_pool);
+    record_copy_buffer(cmd_buffer, source_buffer, dest_buffer, size);
+    end_one_time_command_buffer(command_pool, cmd_buffer);
+}
 
+void DeviceWrapper::record_copy_buffer(VkCommandBuffer cmd_buffer, VkBuffer source_buffer, VkBuffer dest_buffer,
+    VkDeviceSize size) {
     VkBufferCopy copy_region;
     copy_region.srcOffset = 0;
     copy_region.dstOffset = 0;
     copy_region.size = size;
     vkCmdCopyBuffer(cmd_buffer, source_buffer, dest_buffer, 1, &copy_region);
-    end_one_time_command_buffer(command_pool, cmd_buffer);
 }
 
 uint32_t DeviceWrapper::find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) const {
@@ -26,7 +26,10 @@ public:
 
     VkCommandBuffer get_one_time_command_buffer(VkCommandPool command_pool) const;
     void end_one_time_command_buffer(VkCommandPool command_pool, VkCommandBuffer cmd_buffer) const;
+    // Submits without waiting, the returned fence signals once the commands finish
+    VkFence submit_one_time_command_buffer(VkCommandBuffer cmd_buffer) const;
     void copy_buffer(VkCommandPool command_pool, VkBuffer source_buffer, VkBuffer dest_buffer, VkDeviceSize size) const;
+    static void record_copy_buffer(VkCommandBuffer cmd_buffer, VkBuffer source_buffer, VkBuffer dest_buffer, VkDeviceSize size);
 
     uint32_t find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties) const;
     void create_buffer(VkDeviceSize size, VkBufferUsageFlags flags, VkMemoryPropertyFlags properties, VkBuffer* buffer, VkDeviceMemory* buffer_memory) const;
@@ -8,9 +8,10 @@
 namespace engine::vulkan {
 
 
-PipelineWrapper::PipelineWrapper(Arena& temp_arena, BasicRenderer* renderer, DeviceWrapper* device) : m_device_(device),
+PipelineWrapper::PipelineWrapper(Arena& temp_arena, BasicRenderer* renderer, DeviceWrapper* device, VertexFormat vertex_format) : m_device_(device),
     m_pipeline_layout_(nullptr), m_pipeline_(nullptr) {
-    ArrayRef<char> vertex_shader_source = StealthEngine::read_temporary_file(temp_arena, "../Engine/Shaders/triangle.vert.spv");
+    const VertexLayout vertex_layout = get_vertex_layout(vertex_format);
+    ArrayRef<char> vertex_shader_source = StealthEngine::read_temporary_file(temp_arena, vertex_layout.vertex_shader_path);
     ArrayRef<char> fragment_shader_source = StealthEngine::read_temporary_file(temp_arena, "../Engine/Shaders/triangle.frag.spv");
     m_vertex_shader_ = create_shader_module(*device, vertex_shader_source);
     m_fragment_shader_ = create_shader_module(*device, fragment_shader_source);
@@ -34,14 +35,12 @@ PipelineWrapper::PipelineWrapper(Arena& temp_arena, BasicRenderer* renderer, Dev
     dynamic_state_create_info.dynamicStateCount = 2;
     dynamic_state_create_info.pDynamicStates = dynamic_states;
 
-    VkVertexInputBindingDescription binding_description = VulkanModel::Vertex::get_binding_descriptions();
-    auto vertex_attribute_descriptions = VulkanModel::Vertex::get_attribute_descriptions();
     VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info{};
     vertex_input_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertex_input_state_create_info.vertexBindingDescriptionCount = 1;
-    vertex_input_state_create_info.pVertexBindingDescriptions = &binding_description;
-    vertex_input_state_create_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_attribute_descriptions.size());
-    vertex_input_state_create_info.pVertexAttributeDescriptions = vertex_attribute_descriptions.data();
+    vertex_input_state_create_info.pVertexBindingDescriptions = &vertex_layout.binding;
+    vertex_input_state_create_info.vertexAttributeDescriptionCount = vertex_layout.attribute_count;
+    vertex_input_state_create_info.pVertexAttributeDescriptions = vertex_layout.attributes.data();
 
     VkPipelineInputAssemblyStateCreateInfo input_assembly_create_info{};
     input_assembly_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
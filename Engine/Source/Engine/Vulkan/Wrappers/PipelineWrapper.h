@@ -23,7 +23,8 @@ private:
     VkPipelineLayout m_pipeline_layout_;
     VkPipeline m_pipeline_;
 public:
-    PipelineWrapper(Arena& temp_arena, BasicRenderer* renderer, DeviceWrapper* device);
+    // Every model drawn with the pipeline has to be uploaded in vertex_format
+    PipelineWrapper(Arena& temp_arena, BasicRenderer* renderer, DeviceWrapper* device, VertexFormat vertex_format = VertexFormat::FLOAT);
     ~PipelineWrapper();
     
     VkPipelineLayout get_pipeline_layout() const;
@@ -9,7 +9,7 @@ PoolAllocator::Chunk* PoolAllocator::allocate_block() const {
     Chunk* block_begin = static_cast<Chunk*>(m_allocation_arena_->push(block_size));
 
     Chunk* begin = block_begin;
-    for (size_t i = 0; i < m_chunks_per_block_; i++) {
+    for (size_t i = 0; i + 1 < m_chunks_per_block_; i++) {
         begin->next = reinterpret_cast<Chunk*>(reinterpret_cast<char*>(begin) + m_chunk_size_);
         begin = begin->next;
     }
@@ -1,5 +1,6 @@
 ﻿#include "StackAllocator.h"
 
+#include <cstddef>
 #include <cstdlib>
 #include <iostream>
 
@@ -7,11 +8,16 @@ namespace allocators {
 
 static constexpr size_t DEFAULT_STACK_SIZE = 2 << 20;
 
-StackAllocator::StackAllocator() : m_data_(new uint64_t[DEFAULT_STACK_SIZE]), m_size_(0), m_stack_size_(DEFAULT_STACK_SIZE) {
+// stack_size is in bytes, the backing store is in words
+static uint64_t* allocate_words(size_t stack_size) {
+    return new uint64_t[(stack_size + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+}
+
+StackAllocator::StackAllocator() : m_data_(allocate_words(DEFAULT_STACK_SIZE)), m_size_(0), m_stack_size_(DEFAULT_STACK_SIZE) {
     
 }
 
-StackAllocator::StackAllocator(size_t stack_size) : m_data_(new uint64_t[stack_size]), m_size_(0), m_stack_size_(stack_size) {
+StackAllocator::StackAllocator(size_t stack_size) : m_data_(allocate_words(stack_size)), m_size_(0), m_stack_size_(stack_size) {
     
 }
 
@@ -20,16 +26,7 @@ StackAllocator::~StackAllocator() {
 }
 
 void* StackAllocator::allocate(size_t amount) {
-    if (amount == 0) {
-        return nullptr;
-    }
-    uint64_t* current_pos = m_data_ + m_size_;
-    if (m_size_ + amount > m_stack_size_) {
-        // Introduce a linked list type setup with stack allocators
-        return nullptr;
-    }
-    m_size_ += amount;
-    return current_pos;
+    return allocate(amount, alignof(std::max_align_t));
 }
 
 void* StackAllocator::allocate(size_t amount, size_t alignment) {
@@ -39,7 +36,7 @@ void* StackAllocator::allocate(size_t amount, size_t alignment) {
     uintptr_t current_pos = reinterpret_cast<uintptr_t>(m_data_) + m_size_;
     uintptr_t aligned_pos = (current_pos + (alignment - 1)) & ~(alignment - 1);
     size_t padding = aligned_pos - current_pos;
-    size_t new_size = m_size_ + padding;
+    size_t new_size = m_size_ + padding + amount;
     if (new_size > m_stack_size_) {
         // Introduce a linked list type setup with stack allocators
         return nullptr;
@@ -68,7 +65,7 @@ void StackAllocator::clear() {
 }
 
 uint64_t* StackAllocator::get_current_pos() const {
-    return m_data_ + m_size_;
+    return reinterpret_cast<uint64_t*>(reinterpret_cast<uintptr_t>(m_data_) + m_size_);
 }
 
 size_t StackAllocator::get_stack_size() const {
@@ -1,30 +1,59 @@
 ﻿#include "Arena.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <cstring>
 
+struct Arena::Block {
+    Block* previous;
+    allocators::StackAllocator stack;
+
+    Block(Block* previous_block, size_t size) : previous(previous_block), stack(size) { }
+};
+
 Arena::Arena(size_t size) : m_stack_(size) { }
 
+Arena::Arena(size_t size, Growth growth) : m_stack_(size), m_first_block_size_(size), m_next_block_size_(size), m_growth_(growth) { }
+
+Arena::~Arena() {
+    clear();
+}
+
 void* Arena::push(size_t size) {
-    return m_stack_.allocate(size);
+    return push(size, alignof(std::max_align_t));
 }
 
 void* Arena::push(size_t size, size_t alignment) {
-    return m_stack_.allocate(size, alignment);
+    void* data = m_blocks_ != nullptr ? m_blocks_->stack.allocate(size, alignment) : m_stack_.allocate(size, alignment);
+    if (data == nullptr && m_growth_ == Growth::CHAINED && size != 0) {
+        data = push_to_new_block(size, alignment);
+    }
+    return data;
+}
+
+void* Arena::push_to_new_block(size_t size, size_t alignment) {
+    // Room for the padding too, whatever the block's start is aligned to
+    const size_t block_size = std::max(m_next_block_size_, size + alignment);
+    m_blocks_ = new Block(m_blocks_, block_size);
+    m_next_block_size_ = block_size * 2;
+    return m_blocks_->stack.allocate(size, alignment);
 }
 
 void* Arena::push_zero(size_t size) {
-    void* data = m_stack_.allocate(size);
+    void* data = push(size);
     memset(data, 0, size);
     return data;
 }
 
 void* Arena::push_zero(size_t size, size_t alignment) {
-    void* data = m_stack_.allocate(size, alignment);
+    void* data = push(size, alignment);
     memset(data, 0, size);
     return data;
 }
 
 void Arena::pop(size_t size) {
+    assert(m_blocks_ == nullptr && "Markers only cover the first block");
     m_stack_.free_bytes(size);
 }
 
@@ -33,9 +62,16 @@ size_t Arena::get_position() const {
 }
 
 void Arena::set_position(uint64_t* position) {
+    assert(m_blocks_ == nullptr && "Markers only cover the first block");
     m_stack_.free_to_marker(position);
 }
 
 void Arena::clear() {
+    while (m_blocks_ != nullptr) {
+        Block* previous = m_blocks_->previous;
+        delete m_blocks_;
+        m_blocks_ = previous;
+    }
+    m_next_block_size_ = m_first_block_size_;
     m_stack_.clear();
-}
\ No newline at end of file
+}
@@ -1,21 +1,59 @@
 ﻿#pragma once
+#include <algorithm>
+#include <cassert>
+
 #include "Allocators/StackAllocator.h"
 
 class Arena {
+public:
+    enum class Growth : uint8_t {
+        // push returns nullptr once the block is full
+        FIXED,
+        // Full blocks get a new one chained on, each twice the size of the
+        // last, so memory follows what was actually pushed
+        CHAINED,
+    };
+private:
+    struct Block;
+
     allocators::StackAllocator m_stack_;
+    Block* m_blocks_ = nullptr;
+    size_t m_first_block_size_ = 0;
+    size_t m_next_block_size_ = 0;
+    Growth m_growth_ = Growth::FIXED;
+
+    void* push_to_new_block(size_t size, size_t alignment);
 public:
     Arena() = default;
     Arena(size_t size);
-    ~Arena() = default;
+    Arena(size_t size, Growth growth);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) = delete;
+    Arena& operator=(Arena&&) = delete;
 
     void* push(size_t size);
     void* push(size_t size, size_t alignment);
     void* push_zero(size_t size);
     void* push_zero(size_t size, size_t alignment);
+    // Uninitialized room for count elements, valid even for a count of 0
+    template <typename T>
+    T* push_array(size_t count);
 
+    // Markers only cover the first block, so chained arenas can't use them
     void pop(size_t size);
 
     size_t get_position() const;
     void set_position(uint64_t* position);
+    // Frees the chained blocks, the first one is kept
     void clear();
 };
+
+template <typename T>
+T* Arena::push_array(size_t count) {
+    T* data = static_cast<T*>(push(std::max<size_t>(count, 1) * sizeof(T), alignof(T)));
+    assert(data != nullptr && "Arena is too small for the array");
+    return data;
+}
@@ -12,10 +12,14 @@ project "Game"
       "Source",
 	  -- Include Core
 	  "../Engine/Source",
-	  os.getenv("VULKAN_SDK") .. "/Include",
 	  "../Engine/Vendor/glfw/include"
    }
 
+   local vulkanSDKPath = os.getenv("VULKAN_SDK")
+   if vulkanSDKPath then
+      includedirs { vulkanSDKPath .. "/Include" }
+   end
+
    links
    {
       "Engine"
@@ -28,6 +32,10 @@ project "Game"
        systemversion "latest"
        defines { "WINDOWS" }
 
+   -- Static libraries don't carry their system links on Linux
+   filter "system:linux"
+       links { "vulkan", "glfw", "pthread", "dl" }
+
    filter "configurations:Debug"
        defines { "DEBUG" }
        runtime "Debug"
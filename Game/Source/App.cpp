@@ -1,6 +1,11 @@
-#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
 
 #include "Engine/Engine.h"
+#include "Engine/ECS/FlecsBulk.h"
 #include "Engine/Systems/CoreEngineSystems.h"
 #include "Engine/Vulkan/Camera.h"
 
@@ -9,20 +14,41 @@ struct Velocity {
     float speed;
 };
 
-glm::vec3 get_random_direction() {
-    static std::mt19937_64 gen{std::random_device{}()};
-    static std::uniform_real_distribution dist(-1.f, 1.f);
+enum GameEvent : uint16_t {
+    SPAWN_CUBE,
+};
 
-    glm::vec3 direction = glm::vec3(dist(gen), dist(gen), dist(gen));
+struct SpawnCube {
+    flecs::entity_t prefab;
+    glm::vec3 direction;
+};
+
+glm::vec3 get_random_direction(engine::Random& random) {
+    glm::vec3 direction = glm::vec3(random.range(-1.f, 1.f), random.range(-1.f, 1.f), random.range(-1.f, 1.f));
     if (glm::length(direction) > 0.0f) {
         direction = glm::normalize(direction);
     }
     return direction;
 }
 
-void spawn_and_move_cube(const flecs::world& world) {
+void spawn_cube(flecs::world& world, const void* payload, void*) {
+    const auto& spawn = *static_cast<const SpawnCube*>(payload);
+    const flecs::entity prefab = world.entity(spawn.prefab);
+    flecs::entity cube = world.entity().is_a(prefab);
+    cube.set<components::Transform3D>({.translation  = {0.f, 0.f, 2.5f}, .rotation = {0.f, 0.f, 0.f}, .scale = {.5f, .5f, .5f}});
+    cube.set<components::Renderable>({prefab.get<components::Renderable>()->model});
+    // Still a placeholder if the prefab's model is streaming in
+    if (const components::PendingModel* pending = prefab.get<components::PendingModel>()) {
+        cube.set<components::PendingModel>(*pending);
+    }
+    cube.set<Velocity>({.direction = spawn.direction, .speed = .5f});
+}
+
+void spawn_and_move_cube(const flecs::world& world, engine::Random& random, engine::Replay& replay) {
+    replay.set_handler(SPAWN_CUBE, spawn_cube);
     world.system<components::Transform3D, Velocity>()
         .kind(flecs::OnUpdate)
+        .multi_threaded()
         .each([](flecs::entity entity, components::Transform3D& transform, Velocity& velocity) {
             constexpr float rotation_speed = 0.5f;
             constexpr float fall_speed = 0.01f;
@@ -40,38 +66,120 @@ void spawn_and_move_cube(const flecs::world& world) {
     world.system<components::Renderable>()
         .with(flecs::Prefab)
         .kind(flecs::OnUpdate)
-        .each([](flecs::entity entity, components::Renderable& renderable) {
+        .each([&random, &replay](flecs::entity entity, components::Renderable&) {
             static float timer = 0.0f;
             timer += entity.world().delta_time();
             if (timer >= 1.0f) {
                timer = 0.0f;
-               auto world = entity.world();
-               flecs::entity cube = world.entity().is_a(entity);
-               cube.set<components::Transform3D>({.translation  = {0.f, 0.f, 2.5f}, .rotation = {0.f, 0.f, 0.f}, .scale = {.5f, .5f, .5f}});
-               cube.set<components::Renderable>({renderable.model});
-               cube.set<Velocity>({.direction = get_random_direction(), .speed = .5f});
+               // Spawned at the start of the next tick, so replays can stand in for this
+               replay.submit(SPAWN_CUBE, SpawnCube{entity.id(), get_random_direction(random)});
            }
         });
 }
 
-void initialize_world(const flecs::world& world, ArrayRef<engine::vulkan::VulkanModel*> models, float aspect) {
+// Starting population of prefab instances, made with one flecs bulk call per
+// batch instead of moving every entity through its tables one set<> at a time.
+// The batch arrays are reused, so any count fits in cube_arena.
+void spawn_initial_cubes(const flecs::world& world, flecs::entity prefab, int32_t count, Arena& cube_arena, engine::Random& random) {
+    constexpr int32_t batch_size = 4096;
+    auto* transforms = cube_arena.push_array<components::Transform3D>(batch_size);
+    auto* renderables = cube_arena.push_array<components::Renderable>(batch_size);
+    auto* pending_models = cube_arena.push_array<components::PendingModel>(batch_size);
+    auto* velocities = cube_arena.push_array<Velocity>(batch_size);
+    for (int32_t first = 0; first < count; first += batch_size) {
+        const int32_t batch_count = std::min(batch_size, count - first);
+        for (int32_t i = 0; i < batch_count; i++) {
+            transforms[i] = {.translation = {0.f, 0.f, 2.5f}, .rotation = {0.f, 0.f, 0.f}, .scale = glm::vec3{.5f}};
+            renderables[i] = *prefab.get<components::Renderable>();
+            pending_models[i] = *prefab.get<components::PendingModel>();
+            velocities[i] = {.direction = get_random_direction(random), .speed = .5f};
+        }
+        ecs::bulk_create(world, batch_count, prefab, transforms, renderables, pending_models, velocities);
+    }
+    cube_arena.clear();
+}
+
+void initialize_world(const flecs::world& world, const engine::assets::AssetLoader& asset_loader, ArrayRef<engine::assets::ModelHandle> models,
+    float aspect, engine::Random& random, engine::Replay& replay, int32_t initial_cube_count, Arena& cube_arena) {
     world.emplace<Camera>(glm::radians(45.0f), aspect, 0.1f, 10.f);
-    for (engine::vulkan::VulkanModel* model : models) {
+    for (const engine::assets::ModelHandle model : models) {
         flecs::entity cube = world.prefab();
         cube.set<components::Transform3D>({.translation  = {0.f, 0.f, 2.5f}, .rotation = {0.f, 0.f, 0.f}, .scale = glm::vec3{.5f}});
-        cube.set<components::Renderable>({model});
-        cube.set<Velocity>({.direction = get_random_direction(), .speed = .5f});
+        cube.set<components::Renderable>({asset_loader.get_model(model)});
+        cube.set<components::PendingModel>({model});
+        cube.set<Velocity>({.direction = get_random_direction(random), .speed = .5f});
+        if (initial_cube_count > 0) {
+            spawn_initial_cubes(world, cube, initial_cube_count / static_cast<int32_t>(models.size()), cube_arena, random);
+        }
+    }
+    spawn_and_move_cube(world, random, replay);
+}
+
+void print_frame_summary(const engine::profiling::FrameStats& frame_stats) {
+    const engine::profiling::MetricSummary frame_time = frame_stats.summarize(engine::profiling::FrameMetric::FRAME_TIME);
+    if (frame_time.sample_count == 0) {
+        return;
+    }
+    printf("%u frames: %.1f fps mean, p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", frame_time.sample_count,
+        1e9 / frame_time.mean, frame_time.p50 / 1e6, frame_time.p99 / 1e6, frame_time.max / 1e6);
+}
+
+engine::EngineConfig parse_config(int argc, char** argv) {
+    // Half the cores for flecs, the job system takes the rest for asset decoding
+    engine::EngineConfig config{.ecs_threads = static_cast<int32_t>(std::max(std::thread::hardware_concurrency() / 2, 1u))};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            config.headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config.frame_limit = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            config.trace_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--frame-stats") == 0 && i + 1 < argc) {
+            config.frame_stats_file_path = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.random_seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--fixed-dt") == 0 && i + 1 < argc) {
+            config.fixed_delta_time = strtof(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            config.replay_record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            config.replay_playback_path = argv[++i];
+        } else if (strcmp(argv[i], "--vertex-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "quantized") == 0) {
+                config.vertex_format = engine::vulkan::VertexFormat::QUANTIZED;
+            } else if (strcmp(argv[i], "stripped") == 0) {
+                config.vertex_format = engine::vulkan::VertexFormat::QUANTIZED_STRIPPED;
+            }
+        }
+    }
+    return config;
+}
+
+// Game side options, the engine's are left to parse_config
+int32_t parse_initial_cube_count(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--cubes") == 0) {
+            return static_cast<int32_t>(strtol(argv[i + 1], nullptr, 10));
+        }
     }
-    spawn_and_move_cube(world);
+    return 0;
 }
 
-int main() {
+int main(int argc, char** argv) {
     Arena cube_arena{2 << 20};
-	engine::StealthEngine engine;
+	engine::StealthEngine engine{parse_config(argc, argv)};
     flecs::world& world = engine.get_world();
-    engine::vulkan::VulkanModel vase_model = engine.load_model("C:/Users/LyftDriver/Projects/StealthEngine/Game/Models/smooth_vase.obj");
-    engine::vulkan::VulkanModel cube_model = engine.load_model("C:/Users/LyftDriver/Projects/StealthEngine/Game/Models/flat_vase.obj");
-    engine::vulkan::VulkanModel* models[2] = {&vase_model, &cube_model};
-    initialize_world(world, ArrayRef{models, 2}, engine.get_aspect_ratio());
+    // Small enough to load up front, drawn until the vases have streamed in
+    engine::vulkan::VulkanModel placeholder_model = engine.load_model("C:/Users/LyftDriver/Projects/StealthEngine/Game/Models/cube.obj");
+    engine::assets::AssetLoader& asset_loader = engine.get_asset_loader();
+    asset_loader.set_placeholder(&placeholder_model);
+    engine::assets::ModelHandle models[2] = {
+        asset_loader.request_model("C:/Users/LyftDriver/Projects/StealthEngine/Game/Models/smooth_vase.obj"),
+        asset_loader.request_model("C:/Users/LyftDriver/Projects/StealthEngine/Game/Models/flat_vase.obj"),
+    };
+    initialize_world(world, asset_loader, ArrayRef{models, 2}, engine.get_aspect_ratio(), engine.get_random(), engine.get_replay(),
+        parse_initial_cube_count(argc, argv), cube_arena);
     engine.run();
+    print_frame_summary(engine.get_frame_stats());
 }
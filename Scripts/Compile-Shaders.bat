@@ -1,3 +1,4 @@
 ﻿C:/VulkanSDK/1.3.2.296.0/Bin/glslangValidator.exe -V ../Engine/Shaders/triangle.vert -o ../Engine/Shaders/triangle.vert.spv
 C:/VulkanSDK/1.3.296.0/Bin/glslangValidator.exe -V ../Engine/Shaders/triangle.frag -o ../Engine/Shaders/triangle.frag.spv
+C:/VulkanSDK/1.3.296.0/Bin/glslangValidator.exe -V ../Engine/Shaders/quantized.vert -o ../Engine/Shaders/quantized.vert.spv
 pause
\ No newline at end of file